@@ -2,14 +2,42 @@
 
 echo Building object files...
 IF not exist obj (md obj)
-g++ -Wall -fexceptions -g -Isrc\include -c src\SmithWatermanExecutor.cpp -o obj\SmithWatermanExecutor.o
-g++ -Wall -fexceptions -g -Isrc\include -c src\classes\Framework.cpp -o obj\Framework.o
-g++ -Wall -fexceptions -g -Isrc\include -c src\classes\ParallelCoarseOMPImplementation.cpp -o obj\ParallelCoarseOMPImplementation.o -fopenmp
-g++ -Wall -fexceptions -g -Isrc\include -c src\classes\ParallelFineOMPImplementation.cpp -o obj\ParallelFineOMPImplementation.o -fopenmp
-g++ -Wall -fexceptions -g -Isrc\include -c src\classes\SequentialImplementation.cpp -o obj\SequentialImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\SmithWatermanExecutor.cpp -o obj\SmithWatermanExecutor.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\SmithWatermanGenerator.cpp -o obj\SmithWatermanGenerator.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\SmithWatermanTest.cpp -o obj\SmithWatermanTest.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\WorkloadGenerator.cpp -o obj\WorkloadGenerator.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\Aligner.cpp -o obj\Aligner.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\Framework.cpp -o obj\Framework.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\MatrixArena.cpp -o obj\MatrixArena.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ScoringMatrix.cpp -o obj\ScoringMatrix.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ResultCache.cpp -o obj\ResultCache.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\InputFile.cpp -o obj\InputFile.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ReportWriter.cpp -o obj\ReportWriter.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\BatchReader.cpp -o obj\BatchReader.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\PackedSequence.cpp -o obj\PackedSequence.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\Metrics.cpp -o obj\Metrics.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ThreadPool.cpp -o obj\ThreadPool.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ParallelCoarseOMPImplementation.cpp -o obj\ParallelCoarseOMPImplementation.o -fopenmp
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\WavefrontImplementation.cpp -o obj\WavefrontImplementation.o -fopenmp
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ParallelFineOMPImplementation.cpp -o obj\ParallelFineOMPImplementation.o -fopenmp
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ParallelHybridOMPImplementation.cpp -o obj\ParallelHybridOMPImplementation.o -fopenmp
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\ThreadPoolImplementation.cpp -o obj\ThreadPoolImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\SequentialImplementation.cpp -o obj\SequentialImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -mavx2 -c src\classes\SimdStripedImplementation.cpp -o obj\SimdStripedImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\LinearSpaceImplementation.cpp -o obj\LinearSpaceImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -mavx2 -c src\classes\SimdBatchImplementation.cpp -o obj\SimdBatchImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\BitParallelImplementation.cpp -o obj\BitParallelImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\BandedImplementation.cpp -o obj\BandedImplementation.o
+g++ -Wall -fexceptions -g -std=c++17 -Isrc\include -c src\classes\OptimumTracker.cpp -o obj\OptimumTracker.o
+
+echo Constructing the library...
+IF exist libsmithwaterman.a (del libsmithwaterman.a)
+ar rcs libsmithwaterman.a obj\Aligner.o obj\Framework.o obj\ParallelCoarseOMPImplementation.o obj\WavefrontImplementation.o obj\ParallelFineOMPImplementation.o obj\ParallelHybridOMPImplementation.o obj\ThreadPoolImplementation.o obj\SequentialImplementation.o obj\SimdStripedImplementation.o obj\LinearSpaceImplementation.o obj\SimdBatchImplementation.o obj\BitParallelImplementation.o obj\BandedImplementation.o obj\OptimumTracker.o obj\MatrixArena.o obj\ScoringMatrix.o obj\ResultCache.o obj\InputFile.o obj\ReportWriter.o obj\BatchReader.o obj\PackedSequence.o obj\Metrics.o obj\ThreadPool.o
 
 echo Linking files and constructing an executable...
-g++  -o smith_waterman.exe obj\SmithWatermanExecutor.o obj\Framework.o obj\ParallelCoarseOMPImplementation.o obj\ParallelFineOMPImplementation.o obj\SequentialImplementation.o -fopenmp
+g++  -o smith_waterman.exe obj\SmithWatermanExecutor.o libsmithwaterman.a -fopenmp
+g++  -o smith_waterman_gen.exe obj\SmithWatermanGenerator.o obj\WorkloadGenerator.o
+g++  -o smith_waterman_test.exe obj\SmithWatermanTest.o obj\WorkloadGenerator.o libsmithwaterman.a -fopenmp
 IF not exist reports (md reports)
 
 echo Cleaning up...
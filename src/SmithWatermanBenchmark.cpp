@@ -0,0 +1,399 @@
+/**
+ * @file SmithWatermanBenchmark.cpp
+ */
+#include "Aligner.h"
+#include "WorkloadGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <new>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+/**
+* A version of the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> that is benchmarked.
+* @author Georgios Apostolakis
+*/
+struct Engine {
+    /** The value of the input argument '-parallel' that selects the version. */
+    int id;
+
+    /** A short name of the version, for the output of the benchmark. */
+    const char* name;
+
+    /** True if the version uses the '-threads' argument, so it is benchmarked with every number of threads. */
+    bool threaded;
+};
+
+/** The versions of the algorithm that are benchmarked (a new version needs only a new entry here and in Aligner#createEngine()). */
+const Engine ENGINES[] = {
+    {1, "sequential", false},
+    {2, "coarse", true},
+    {3, "fine", true},
+    {4, "simd-striped", false},
+    {5, "linear-space", false},
+    {6, "simd-batch", false},
+    {7, "bit-parallel", false},
+    {8, "hybrid", true},
+    {9, "thread-pool", true},
+    {10, "banded", false}
+};
+
+/**
+* The measurements of a single execution of the benchmark.
+* @author Georgios Apostolakis
+*/
+struct Measurement {
+    /** False if the execution failed (e.g. the version threw an exception or crashed). */
+    bool ok;
+
+    /** The time that the alignment of the pairs and the report lasted (in seconds). */
+    double seconds;
+
+    /** The cells of the scoring matrices that were computed (see {@link Statistics#cellUpdates}). */
+    long long int cellUpdates;
+
+    /** The cells of the scoring matrices with a value greater than zero. */
+    long long int cellsGreaterThanZero;
+
+    /** The number of times that memory was allocated for the scoring matrices. */
+    long long int matrixAllocations;
+
+    /** The number of calls of the operator new. */
+    long long int allocations;
+
+    /** The bytes that were requested by the calls of the operator new. */
+    long long int allocatedBytes;
+
+    /** The maximum number of bytes that were held by the operator new at the same time (besides those of the benchmark itself). */
+    long long int peakHeapBytes;
+
+    /** The maximum resident set size of the process of the execution (in kilobytes). */
+    long long int peakRssKb;
+};
+
+/** The number of calls of the operator new (since the start of the current execution). */
+static atomic<long long int> allocationCount(0);
+
+/** The bytes that were requested by the calls of the operator new (since the start of the current execution). */
+static atomic<long long int> allocatedBytes(0);
+
+/** The bytes that are currently held by the operator new. */
+static atomic<long long int> heapBytes(0);
+
+/** The maximum value of {@link #heapBytes} (since the start of the current execution). */
+static atomic<long long int> peakHeapBytes(0);
+
+/** The bytes in front of every block of the operator new, where its size is kept (a multiple of the alignment of new). */
+static const size_t HEADER_SIZE = 16;
+
+void* operator new(size_t size){
+    char* block = (char*)malloc(size + HEADER_SIZE);
+    if(block==0)
+        throw bad_alloc();
+    *(size_t*)block = size;
+
+    allocationCount++;
+    allocatedBytes += size;
+    long long int held = heapBytes += size, peak = peakHeapBytes;
+    while(held>peak && !peakHeapBytes.compare_exchange_weak(peak, held));
+    return block + HEADER_SIZE;
+}
+
+void* operator new[](size_t size){
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept{
+    if(memory==0)
+        return;
+    char* block = (char*)memory - HEADER_SIZE;
+    heapBytes -= *(size_t*)block;
+    free(block);
+}
+
+void operator delete[](void* memory) noexcept{
+    operator delete(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept{
+    operator delete(memory);
+}
+
+/**
+ * Provides the bytes in front of a block of the aligned operator new, where its size is kept. They are a multiple of the alignment,
+ * so the memory after them stays aligned.
+ * @param alignment The alignment of the block.
+ * @return The number of bytes in front of the block.
+ */
+static size_t aligned_header(align_val_t alignment){
+    return (size_t)alignment>HEADER_SIZE ? (size_t)alignment : HEADER_SIZE;
+}
+
+void* operator new(size_t size, align_val_t alignment){
+    size_t header = aligned_header(alignment);
+    size_t bytes = (size + header + (size_t)alignment - 1)/(size_t)alignment*(size_t)alignment;  //aligned_alloc needs a multiple of the alignment
+    char* block = (char*)aligned_alloc((size_t)alignment, bytes);
+    if(block==0)
+        throw bad_alloc();
+    *(size_t*)block = size;
+
+    allocationCount++;
+    allocatedBytes += size;
+    long long int held = heapBytes += size, peak = peakHeapBytes;
+    while(held>peak && !peakHeapBytes.compare_exchange_weak(peak, held));
+    return block + header;
+}
+
+void* operator new[](size_t size, align_val_t alignment){
+    return operator new(size, alignment);
+}
+
+void operator delete(void* memory, align_val_t alignment) noexcept{
+    if(memory==0)
+        return;
+    char* block = (char*)memory - aligned_header(alignment);
+    heapBytes -= *(size_t*)block;
+    free(block);
+}
+
+void operator delete[](void* memory, align_val_t alignment) noexcept{
+    operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, size_t, align_val_t alignment) noexcept{
+    operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, size_t, align_val_t alignment) noexcept{
+    operator delete(memory, alignment);
+}
+
+/**
+ * Splits a comma-separated list of integers.
+ * @param list The list (e.g. "1,2,4").
+ * @return A vector with the integers.
+ * @throws std::invalid_argument Thrown if an item of the list is not an integer.
+ */
+vector<long long int> splitList(const string& list){
+    vector<long long int> items;
+    stringstream stream(list);
+    string item;
+    while(getline(stream, item, ','))
+        items.push_back(stoll(item));
+    return items;
+}
+
+/**
+ * Executes a version of the algorithm in a child process, so that its allocations and its memory high-water mark
+ * are not mixed with those of the other executions.
+ * @param engine The version of the algorithm.
+ * @param args The arguments of the version.
+ * @return A {@link Measurement} object with the measurements of the execution.
+ */
+Measurement measure(const Engine& engine, const vector<string>& args){
+    Measurement result = Measurement();
+    int channel[2];
+    if(pipe(channel)!=0)
+        return result;
+
+    cout.flush();
+    pid_t child = fork();
+    if(child==0){
+        close(channel[0]);
+        long long int baseline = heapBytes;  //the memory of the benchmark itself
+        allocationCount = 0;
+        allocatedBytes = 0;
+        peakHeapBytes = baseline;
+
+        vector<char*> argv;
+        for(size_t i=0;i<args.size();i++)
+            argv.push_back(const_cast<char*>(args[i].c_str()));
+        try{
+            Framework* framework = Aligner::createEngine(engine.id, argv.size(), argv.data());
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            framework->runAlgorithm();
+            framework->printResultsToFile();
+            result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            const Statistics& statistics = framework->getStatistics();
+            result.cellUpdates = statistics.cellUpdates;
+            result.cellsGreaterThanZero = statistics.cellsGreaterThanZero;
+            result.matrixAllocations = statistics.matrixAllocations;
+            result.allocations = allocationCount;
+            result.allocatedBytes = allocatedBytes;
+            result.peakHeapBytes = peakHeapBytes - baseline;
+            delete framework;
+            result.ok = true;
+        }catch(const std::exception& e){
+            cerr << engine.name << ": " << e.what() << endl;
+        }
+        if(write(channel[1], &result, sizeof(result))!=(ssize_t)sizeof(result))
+            _exit(1);
+        _exit(0);
+    }
+
+    close(channel[1]);
+    if(child>0){
+        struct rusage usage;
+        int status;
+        if(read(channel[0], &result, sizeof(result))!=(ssize_t)sizeof(result))
+            result = Measurement();  //the child crashed
+        if(wait4(child, &status, 0, &usage)==child)
+            result.peakRssKb = usage.ru_maxrss;
+    }
+    close(channel[0]);
+    return result;
+}
+
+/**
+ * The main function of the benchmark. It executes every version of the algorithm over every combination of the given
+ * sequence lengths, pair counts, thread counts and scores, and prints one record per execution (as CSV or JSON).
+ * The valid arguments are (all of them are optional):
+ * - {@code -engines <list>}, the versions to execute (the values of '-parallel', default all of them),
+ * - {@code -lengths <list>}, the lengths of the sequences (default 100,1000),
+ * - {@code -pairs <list>}, the numbers of pairs (default 100),
+ * - {@code -threads <list>}, the numbers of threads of the parallel versions (default 1,2,4),
+ * - {@code -scores <list>}, triplets of match:mismatch:gap scores (default 2:-1:-1,1:-1:0),
+ * - {@code -mutation <double>}, the probability that a symbol of Q is mutated in D (default 0.1, see {@link WorkloadGenerator}),
+ * - {@code -seed <integer>}, the seed of the random pairs (default 1),
+ * - {@code -format csv|json}, the format of the records (default csv),
+ * - {@code -output <string>}, the file where the records are written (default the console).
+ * @param argc An integer with the size of the {@code argv} argument.
+ * @param argv An array with the arguments provided by the user.
+ * @return An integer with the value 0 if every execution succeeded, otherwise 1.
+ */
+int main(int argc, char* argv[]){
+    vector<long long int> engines, lengths = {100, 1000}, pairs = {100}, threads = {1, 2, 4};
+    vector<string> scores = {"2:-1:-1", "1:-1:0"};
+    string format = "csv", outputPath;
+    WorkloadSettings workload;
+    int status = 0;
+
+    workload.distribution = FIXED_LENGTH;
+    workload.lengthB = 0;
+    workload.alphabet = "ACGT";
+    workload.mutationRate = 0.1;
+    workload.duplicateRatio = 0;
+    workload.seed = 1;
+    for(const Engine& engine : ENGINES)
+        engines.push_back(engine.id);
+    try{
+        for(int i=1;i<argc-1;i+=2){
+            string name = argv[i], value = argv[i+1];
+            if(name=="-engines") engines = splitList(value);
+            else if(name=="-lengths") lengths = splitList(value);
+            else if(name=="-pairs") pairs = splitList(value);
+            else if(name=="-threads") threads = splitList(value);
+            else if(name=="-mutation") workload.mutationRate = stod(value);
+            else if(name=="-seed") workload.seed = stoull(value);
+            else if(name=="-format") format = value;
+            else if(name=="-output") outputPath = value;
+            else if(name=="-scores"){
+                scores.clear();
+                stringstream stream(value);
+                string item;
+                while(getline(stream, item, ','))
+                    scores.push_back(item);
+            }
+            else
+                throw invalid_argument("Unknown argument " + name + ".");
+        }
+        if(format!="csv" && format!="json")
+            throw invalid_argument("The format must be csv or json.");
+    }catch(const std::exception& e){
+        cerr << "Error. Invalid arguments (" << e.what() << "). Program will be terminated." << endl;
+        return 1;
+    }
+
+    ofstream file;
+    if(!outputPath.empty()){
+        file.open(outputPath.c_str());
+        if(!file.is_open()){
+            cerr << "Output file " << outputPath << " cannot be opened. Program will be terminated." << endl;
+            return 1;
+        }
+    }
+    ostream& output = outputPath.empty() ? cout : file;
+
+    const string inputPath = "reports/Bench_input.txt";
+    bool first = true;
+    if(format=="csv")
+        output << "engine,parallel,threads,pairs,length,match,mismatch,gap,ok,seconds,cell_updates,gcups,cells_greater_than_zero,matrix_allocations,allocations,allocated_bytes,peak_heap_bytes,peak_rss_kb" << endl;
+    else
+        output << "[";
+
+    for(long long int pairCount : pairs){
+        for(long long int length : lengths){
+            try{
+                workload.pairs = pairCount;
+                workload.lengthA = length;
+                WorkloadGenerator(workload).write(inputPath);
+            }catch(const std::exception& e){
+                cerr << e.what() << " Program will be terminated." << endl;
+                return 1;
+            }
+            for(const string& score : scores){
+                string match, mismatch, gap;
+                stringstream stream(score);
+                getline(stream, match, ':');
+                getline(stream, mismatch, ':');
+                getline(stream, gap, ':');
+
+                for(long long int id : engines){
+                    const Engine* engine = 0;
+                    for(const Engine& candidate : ENGINES)
+                        if(candidate.id==id)
+                            engine = &candidate;
+                    if(engine==0){
+                        cerr << "Error. There is no version with -parallel " << id << "." << endl;
+                        status = 1;
+                        continue;
+                    }
+
+                    for(size_t t=0;t<(engine->threaded ? threads.size() : 1);t++){
+                        long long int threadCount = engine->threaded ? threads[t] : 1;
+                        vector<string> args = {"smith_waterman", "-parallel", to_string(id), "-threads", to_string(threadCount),
+                                               "-path", inputPath, "-id", "Bench", "-match", match, "-mismatch", mismatch, "-gap", gap};
+                        Measurement m = measure(*engine, args);
+                        double gcups = m.seconds>0 ? m.cellUpdates/m.seconds/1e9 : 0;
+                        if(!m.ok)
+                            status = 1;
+
+                        if(format=="csv"){
+                            output << engine->name << ',' << id << ',' << threadCount << ',' << pairCount << ',' << length << ','
+                                   << match << ',' << mismatch << ',' << gap << ',' << (m.ok ? "true" : "false") << ',' << m.seconds << ','
+                                   << m.cellUpdates << ',' << gcups << ',' << m.cellsGreaterThanZero << ',' << m.matrixAllocations << ','
+                                   << m.allocations << ',' << m.allocatedBytes << ',' << m.peakHeapBytes << ',' << m.peakRssKb << endl;
+                        }
+                        else{
+                            output << (first ? "\n" : ",\n") << "  {\"engine\": \"" << engine->name << "\", \"parallel\": " << id
+                                   << ", \"threads\": " << threadCount << ", \"pairs\": " << pairCount << ", \"length\": " << length
+                                   << ", \"match\": " << match << ", \"mismatch\": " << mismatch << ", \"gap\": " << gap
+                                   << ", \"ok\": " << (m.ok ? "true" : "false") << ", \"seconds\": " << m.seconds
+                                   << ", \"cell_updates\": " << m.cellUpdates << ", \"gcups\": " << gcups
+                                   << ", \"cells_greater_than_zero\": " << m.cellsGreaterThanZero << ", \"matrix_allocations\": " << m.matrixAllocations
+                                   << ", \"allocations\": " << m.allocations << ", \"allocated_bytes\": " << m.allocatedBytes
+                                   << ", \"peak_heap_bytes\": " << m.peakHeapBytes << ", \"peak_rss_kb\": " << m.peakRssKb << "}";
+                            output.flush();
+                        }
+                        first = false;
+                    }
+                }
+            }
+        }
+    }
+    if(format=="json")
+        output << "\n]" << endl;
+
+    remove(inputPath.c_str());
+    remove("reports/Report_Bench.txt");
+    return status;
+}
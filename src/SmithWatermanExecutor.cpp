@@ -1,21 +1,11 @@
 /**
  * @file SmithWatermanExecutor.cpp
  */
-#include "SequentialImplementation.h"
-#include "ParallelCoarseOMPImplementation.h"
-#include "ParallelFineOMPImplementation.h"
+#include "Aligner.h"
+#include <memory>
 
 using namespace std;
 
-/** The integer value of this constant is the value of the input argument '-parallel' that determines a sequential execution of the algorithm.*/
-const int SEQUENTIAL_IMPL = 1;
-
-/** The integer value of this constant is the value of the input argument '-parallel' that determines a coarse-level parallel execution of the algorithm.*/
-const int PARALLEL_COARSE_IMPL = 2;
-
-/** The integer value of this constant is the value of the input argument '-parallel' that determines a fine-level parallel execution of the algorithm.*/
-const int PARALLEL_FINE_IMPL = 3;
-
 /**
  * Determines which version of the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> to execute, based
  * on the input arguments. If no arguments were provided, it lets the user to
@@ -23,7 +13,7 @@ const int PARALLEL_FINE_IMPL = 3;
  * @param argc An integer with the size of the {@code argv} argument.
  * @param argv An array with the arguments provided by the user.
  * @return An integer with the numerical value of the respective constant
- * ({@link #SEQUENTIAL_IMPL}, {@link #PARALLEL_COARSE_IMPL}, {@link #PARALLEL_FINE_IMPL})
+ * ({@link #SEQUENTIAL_IMPL}, {@link #PARALLEL_COARSE_IMPL}, {@link #PARALLEL_FINE_IMPL}, {@link #SIMD_STRIPED_IMPL}, {@link #LINEAR_SPACE_IMPL}, {@link #SIMD_BATCH_IMPL}, {@link #BIT_PARALLEL_IMPL}, {@link #PARALLEL_HYBRID_IMPL}, {@link #THREAD_POOL_IMPL}, {@link #BANDED_IMPL})
  * which indicates the version of the algorithm to execute.
  */
 int selectAlgorithm(int argc, char* argv[]){
@@ -34,6 +24,13 @@ int selectAlgorithm(int argc, char* argv[]){
         cout << "  " + to_string(SEQUENTIAL_IMPL) + ". Sequential implementation." << endl;
         cout << "  " + to_string(PARALLEL_COARSE_IMPL) + ". Parallel coarse-grained implementation." << endl;
         cout << "  " + to_string(PARALLEL_FINE_IMPL) + ". Parallel fine-grained implementation." << endl;
+        cout << "  " + to_string(SIMD_STRIPED_IMPL) + ". Striped SIMD implementation." << endl;
+        cout << "  " + to_string(LINEAR_SPACE_IMPL) + ". Linear-space implementation." << endl;
+        cout << "  " + to_string(SIMD_BATCH_IMPL) + ". Inter-sequence SIMD implementation." << endl;
+        cout << "  " + to_string(BIT_PARALLEL_IMPL) + ". Bit-parallel implementation (only for gap score 0, mismatch score <= 0 and match score > 0)." << endl;
+        cout << "  " + to_string(PARALLEL_HYBRID_IMPL) + ". Parallel hybrid implementation." << endl;
+        cout << "  " + to_string(THREAD_POOL_IMPL) + ". Thread pool implementation." << endl;
+        cout << "  " + to_string(BANDED_IMPL) + ". Banded implementation." << endl;
         cin >> algo;
     }
     else {
@@ -55,38 +52,20 @@ int selectAlgorithm(int argc, char* argv[]){
  */
 int main(int argc, char* argv[]){
     int algo = selectAlgorithm(argc, argv);
-    if(algo==SEQUENTIAL_IMPL){
-        try{
-            SequentialImplementation ser(argc, argv);
-            ser.runAlgorithm();
-            ser.printResultsToFile();
-            ser.printStatistics();
-        }catch(const std::exception& e) {
-            cerr << e.what() << " Program will be terminated." << endl;
-        }
-    }
-    else if(algo==PARALLEL_COARSE_IMPL){
-        try{
-            ParallelCoarseOMPImplementation par(argc, argv);
-            par.runAlgorithm();
-            par.printResultsToFile();
-            par.printStatistics();
-        }catch(const std::exception& e) {
-            cerr << e.what() << " Program will be terminated." << endl;
-        }
-    }
-    else if(algo==PARALLEL_FINE_IMPL){
-        try{
-            ParallelFineOMPImplementation par(argc, argv);
-            par.runAlgorithm();
-            par.printResultsToFile();
-            par.printStatistics();
-        }catch(const std::exception& e) {
-            cerr << e.what() << " Program will be terminated." << endl;
+    try{
+        unique_ptr<Framework> framework(Aligner::createEngine(algo, argc, argv));
+        if(!framework){
+            cerr << "Error. Invalid arguments. Program will be terminated." << endl;
+            return 0;
         }
+        framework->runAlgorithm();
+        framework->printResultsToFile();
+        framework->saveCache();
+        framework->saveMetrics();
+        framework->printStatistics();
+    }catch(const std::exception& e) {
+        cerr << e.what() << " Program will be terminated." << endl;
     }
-    else
-		cerr << "Error. Invalid arguments. Program will be terminated." << endl;
-	
+
 	return 0;
 }
@@ -0,0 +1,90 @@
+/**
+ * @file SmithWatermanGenerator.cpp
+ */
+#include "WorkloadGenerator.h"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * Parses the length distribution of a workload, given as {@code fixed:N}, {@code uniform:MIN:MAX} or {@code lognormal:MEDIAN:SIGMA}.
+ * @param value The argument of the user.
+ * @param settings The {@link WorkloadSettings} object where the distribution and its parameters are stored.
+ * @throws std::invalid_argument Thrown if the distribution is invalid.
+ */
+void parseLength(const string& value, WorkloadSettings& settings){
+    vector<string> parts;
+    stringstream stream(value);
+    string part;
+    while(getline(stream, part, ':'))
+        parts.push_back(part);
+
+    if(parts.size()==2 && parts[0]=="fixed")
+        settings.distribution = FIXED_LENGTH;
+    else if(parts.size()==3 && parts[0]=="uniform")
+        settings.distribution = UNIFORM_LENGTH;
+    else if(parts.size()==3 && parts[0]=="lognormal")
+        settings.distribution = LOG_NORMAL_LENGTH;
+    else
+        throw invalid_argument("Error. Invalid length distribution " + value + ".");
+    settings.lengthA = stod(parts[1]);
+    settings.lengthB = parts.size()==3 ? stod(parts[2]) : 0;
+}
+
+/**
+ * The main function of the workload generator, which writes synthetic pairs of sequences in the format of the input files.
+ * The valid arguments are (all of them are optional):
+ * - {@code -pairs <integer>}, the number of pairs (default 1000),
+ * - {@code -length <string>}, the distribution of the lengths of the Q sequences: {@code fixed:N}, {@code uniform:MIN:MAX} or
+ * {@code lognormal:MEDIAN:SIGMA} (default fixed:1000),
+ * - {@code -alphabet <string>}, the symbols of the sequences (default ACGT),
+ * - {@code -mutation <double>}, the probability that a symbol of Q is mutated in D (default 0.1),
+ * - {@code -duplicates <double>}, the probability that a pair repeats one of the last 1024 distinct ones (default 0),
+ * - {@code -seed <integer>}, the seed of the random generator (default 1),
+ * - {@code -path <string>}, the file of the workload (default the console).
+ * @param argc An integer with the size of the {@code argv} argument.
+ * @param argv An array with the arguments provided by the user.
+ * @return An integer with the value 0 on success, otherwise 1.
+ */
+int main(int argc, char* argv[]){
+    WorkloadSettings settings;
+    string path;
+
+    settings.pairs = 1000;
+    settings.distribution = FIXED_LENGTH;
+    settings.lengthA = 1000;
+    settings.lengthB = 0;
+    settings.alphabet = "ACGT";
+    settings.mutationRate = 0.1;
+    settings.duplicateRatio = 0;
+    settings.seed = 1;
+
+    try{
+        for(int i=1;i<argc-1;i+=2){
+            string name = argv[i], value = argv[i+1];
+            if(name=="-pairs") settings.pairs = stoull(value);
+            else if(name=="-length") parseLength(value, settings);
+            else if(name=="-alphabet") settings.alphabet = value;
+            else if(name=="-mutation") settings.mutationRate = stod(value);
+            else if(name=="-duplicates") settings.duplicateRatio = stod(value);
+            else if(name=="-seed") settings.seed = stoull(value);
+            else if(name=="-path") path = value;
+            else
+                throw invalid_argument("Error. Unknown argument " + name + ".");
+        }
+        if(argc%2==0)
+            throw invalid_argument("Error. The argument " + string(argv[argc-1]) + " has no value.");
+
+        WorkloadGenerator generator(settings);
+        if(path.empty())
+            generator.write(cout);
+        else
+            generator.write(path);
+    }catch(const std::exception& e){
+        cerr << e.what() << " Program will be terminated." << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file SmithWatermanTest.cpp
+ */
+#include "Aligner.h"
+#include "WorkloadGenerator.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <set>
+#include <algorithm>
+
+using namespace std;
+
+/** The versions of the algorithm that use the '-threads' argument. */
+const int THREADED_ENGINES[] = {PARALLEL_COARSE_IMPL, PARALLEL_FINE_IMPL, PARALLEL_HYBRID_IMPL, THREAD_POOL_IMPL};
+
+/** The scores of the tests (the second one suits the bit-parallel kernel, the last one the 8-bit SIMD kernels). */
+const Scores TEST_SCORES[] = {{2, -1, -1, 0, false}, {1, -1, 0, 0, false}, {1, -3, -2, 0, false}};
+
+/** The number of checks that failed. */
+static int failures = 0;
+
+/**
+ * Records the outcome of a check, and prints its description if it failed.
+ * @param passed True if the check passed.
+ * @param description A description of the check.
+ */
+void check(bool passed, const string& description){
+    if(!passed){
+        failures++;
+        cerr << "FAILED: " << description << endl;
+    }
+}
+
+/**
+ * Reads the contents of a file.
+ * @param path The path of the file.
+ * @return A string with the contents of the file (empty if it cannot be read).
+ */
+string readFile(const string& path){
+    ifstream input(path.c_str(), ios::binary);
+    stringstream contents;
+    contents << input.rdbuf();
+    return contents.str();
+}
+
+/**
+ * Executes a version of the algorithm like the command line does, and provides its report.
+ * @param engine The version of the algorithm (the value of '-parallel').
+ * @param scores The scores of the alignments.
+ * @param args The arguments besides the scores and the ID of the report (e.g. '-path'). Unless they are given, 2 threads and
+ * a band that covers every pair are used.
+ * @param hits A pointer where the number of pairs that were found in the cache is stored (ignored if it is null).
+ * @return A string with the contents of the report.
+ * @throws std::exception Thrown if the version throws an exception.
+ */
+string runEngine(int engine, const Scores& scores, const vector<string>& args, long long int* hits = 0){
+    string id = "Test_" + to_string(engine);
+    vector<string> all = {"smith_waterman", "-id", id,
+                          "-match", to_string(scores.matchScore), "-mismatch", to_string(scores.mismatchScore), "-gap", to_string(scores.gapScore)};
+    all.insert(all.end(), args.begin(), args.end());
+    if(find(args.begin(), args.end(), "-threads")==args.end())
+        all.insert(all.end(), {"-threads", "2"});
+    if(find(args.begin(), args.end(), "-band")==args.end())
+        all.insert(all.end(), {"-band", "100000"});
+    vector<char*> argv;
+    for(size_t i=0;i<all.size();i++)
+        argv.push_back(const_cast<char*>(all[i].c_str()));
+
+    unique_ptr<Framework> framework(Aligner::createEngine(engine, argv.size(), argv.data()));
+    framework->runAlgorithm();
+    framework->printResultsToFile();
+    framework->saveCache();
+    if(hits!=0)
+        *hits = framework->getCacheHits();
+    framework.reset();  //the report is complete once the version is destroyed
+
+    string path = "reports/Report_" + id + ".txt";
+    string report = readFile(path);
+    remove(path.c_str());
+    return report;
+}
+
+/**
+ * Writes a synthetic workload of DNA pairs into a file (see {@link WorkloadGenerator}).
+ * @param path The path of the file.
+ * @param pairs The number of pairs.
+ * @param duplicateRatio The probability that a pair repeats an earlier one.
+ */
+void writeWorkload(const string& path, size_t pairs, double duplicateRatio){
+    WorkloadSettings settings;
+    settings.pairs = pairs;
+    settings.distribution = UNIFORM_LENGTH;
+    settings.lengthA = 20;
+    settings.lengthB = 120;
+    settings.alphabet = "ACGT";
+    settings.mutationRate = 0.1;
+    settings.duplicateRatio = duplicateRatio;
+    settings.seed = 7;
+    WorkloadGenerator(settings).write(path);
+}
+
+/**
+ * Checks that every version of the algorithm writes the same report as the sequential version for every bundled dataset.
+ */
+void testEnginesAgainstSequential(void){
+    vector<string> datasets;
+    for(const filesystem::directory_entry& entry : filesystem::directory_iterator("datasets"))
+        if(entry.path().extension()==".txt")
+            datasets.push_back(entry.path().string());
+    sort(datasets.begin(), datasets.end());
+    check(!datasets.empty(), "the bundled datasets are found");
+
+    for(const string& dataset : datasets){
+        for(const Scores& scores : TEST_SCORES){
+            string expected = runEngine(SEQUENTIAL_IMPL, scores, {"-path", dataset});
+            for(int engine=PARALLEL_COARSE_IMPL;engine<=BANDED_IMPL;engine++)
+                check(runEngine(engine, scores, {"-path", dataset})==expected,
+                      "version " + to_string(engine) + " reports " + dataset + " like the sequential version");
+        }
+    }
+}
+
+/**
+ * Checks that the parallel versions and the library reject zero threads.
+ */
+void testZeroThreads(void){
+    for(int engine : THREADED_ENGINES){
+        bool rejected = false;
+        try{
+            runEngine(engine, TEST_SCORES[0], {"-memory", "-threads", "0"});
+        }catch(const invalid_argument&){
+            rejected = true;
+        }
+        check(rejected, "version " + to_string(engine) + " rejects -threads 0");
+    }
+
+    bool rejected = false;
+    try{
+        Aligner aligner(TEST_SCORES[0], SEQUENTIAL_IMPL, 0);
+    }catch(const invalid_argument&){
+        rejected = true;
+    }
+    check(rejected, "the Aligner rejects 0 threads");
+}
+
+/**
+ * Checks that a pipelined execution writes the same report as the whole input file, for batches that end exactly at,
+ * just before and just after the last pair, and around the windows of the pairs that are aligned together.
+ * @param path The path of the input file.
+ * @param pairs The number of pairs of the input file.
+ */
+void testBatches(const string& path, size_t pairs){
+    const Scores& scores = TEST_SCORES[0];
+    string expected = runEngine(SEQUENTIAL_IMPL, scores, {"-path", path});
+    const size_t batches[] = {1, 255, 256, 257, pairs-1, pairs, pairs+1};
+    for(int engine : {SEQUENTIAL_IMPL, PARALLEL_COARSE_IMPL, SIMD_BATCH_IMPL, THREAD_POOL_IMPL})
+        for(size_t batch : batches)
+            check(runEngine(engine, scores, {"-path", path, "-batch", to_string(batch)})==expected,
+                  "version " + to_string(engine) + " with -batch " + to_string(batch) + " reports like the whole file");
+}
+
+/**
+ * Checks that a saved cache is loaded by the next execution, which finds every pair in it and writes the same report.
+ * @param path The path of the input file.
+ * @param pairs The number of pairs of the input file.
+ */
+void testCacheRoundTrip(const string& path, size_t pairs){
+    const Scores& scores = TEST_SCORES[0];
+    const string cachePath = "reports/Test.cache";
+    remove(cachePath.c_str());
+    string expected = runEngine(SEQUENTIAL_IMPL, scores, {"-path", path, "-cache-size", "0"});
+
+    long long int hits = 0;
+    check(runEngine(SIMD_STRIPED_IMPL, scores, {"-path", path, "-cache", cachePath}, &hits)==expected, "the report is the same while the cache is saved");
+    check(hits>0 && hits<(long long int)pairs, "the duplicate pairs are found in the cache");
+    check(runEngine(SEQUENTIAL_IMPL, scores, {"-path", path, "-cache", cachePath, "-batch", "100"}, &hits)==expected, "the report is the same with the loaded cache");
+    check(hits==(long long int)pairs, "every pair is found in the loaded cache");
+    remove(cachePath.c_str());
+}
+
+/**
+ * Checks that two alignments are identical.
+ * @param a The first alignment.
+ * @param b The second alignment.
+ * @return True if they have the same score, positions and aligned sequences.
+ */
+bool sameResult(const Result& a, const Result& b){
+    return a.score==b.score && a.start==b.start && a.stop==b.stop &&
+           a.result_pair.q==b.result_pair.q && a.result_pair.d==b.result_pair.d;
+}
+
+/**
+ * Checks that two vectors hold the same alignments for every pair.
+ * @param a The alignments of the first execution.
+ * @param b The alignments of the second execution.
+ * @return True if the alignments are identical.
+ */
+bool sameResults(const vector<vector<Result>>& a, const vector<vector<Result>>& b){
+    if(a.size()!=b.size())
+        return false;
+    for(size_t i=0;i<a.size();i++)
+        if(a[i].size()!=b[i].size() || !equal(a[i].begin(), a[i].end(), b[i].begin(), sameResult))
+            return false;
+    return true;
+}
+
+/**
+ * Checks the library (see {@link Aligner}): every version aligns the pairs in memory like the sequential version (with both
+ * kinds of output), the pairs with an empty sequence have no alignments, and the statistics count the cells of every distinct pair.
+ * @param path The path of an input file, whose pairs are aligned.
+ */
+void testAligner(const string& path){
+    vector<string> sequences;  //the Q and the D sequence of every pair
+    stringstream input(readFile(path));
+    string label, sequence;
+    while(input >> label >> sequence)
+        sequences.push_back(sequence);
+    sequences.insert(sequences.end(), {"", "ACGT", "ACGT", "", "", ""});
+
+    vector<SequencePair> pairs(sequences.size()/2);
+    set<pair<string, string>> distinct;  //the duplicate pairs are found in the cache, so their cells are not computed
+    long long int cells = 0;
+    for(size_t i=0;i<pairs.size();i++){
+        pairs[i].q = sequences[2*i];
+        pairs[i].d = sequences[2*i+1];
+        if(distinct.insert(make_pair(sequences[2*i], sequences[2*i+1])).second)
+            cells += (long long int)pairs[i].q.size()*pairs[i].d.size();
+    }
+
+    for(const Scores& scores : TEST_SCORES){
+        vector<vector<Result>> expected;
+        Aligner sequential(scores, SEQUENTIAL_IMPL, 1);
+        sequential.align(pairs.data(), pairs.size(), expected);
+        check(sequential.getStatistics().cellUpdates==cells, "the Aligner counts the cells of every distinct pair");
+        for(size_t i=pairs.size()-3;i<pairs.size();i++)
+            check(expected[i].empty(), "a pair with an empty sequence has no alignments");
+
+        for(int engine=SEQUENTIAL_IMPL;engine<=BANDED_IMPL;engine++){
+            Aligner aligner(scores, engine, 2);
+            vector<vector<Result>> results;
+            aligner.align(pairs.data(), pairs.size(), results);
+            if(engine!=BANDED_IMPL) //the adaptive band of the library may miss an alignment that leaves it
+                check(sameResults(results, expected), "version " + to_string(engine) + " aligns the pairs in memory like the sequential version");
+            for(size_t i=pairs.size()-3;i<pairs.size();i++)
+                check(results[i].empty(), "version " + to_string(engine) + " finds no alignments for an empty sequence");
+
+            vector<vector<Result>> streamed(pairs.size());
+            aligner.align(pairs.data(), pairs.size(), [&streamed](size_t i, vector<Result>& pair_results){
+                streamed[i] = pair_results;  //every pair has its own vector, so the threads do not interfere
+            });
+            check(sameResults(streamed, results), "version " + to_string(engine) + " hands the same alignments to the callback");
+        }
+    }
+}
+
+/**
+ * The main function, which executes the tests of the versions of the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> (make test).
+ * It must be executed from the root directory of the project, where the bundled datasets and the reports are.
+ * @return An integer with the value 0 if every check passed, otherwise 1.
+ */
+int main(void){
+    const string workload = "reports/Test_input.txt";
+    const size_t pairs = 600;
+    try{
+        writeWorkload(workload, pairs, 0.2);
+        testEnginesAgainstSequential();
+        testZeroThreads();
+        testBatches(workload, pairs);
+        testCacheRoundTrip(workload, pairs);
+        testAligner(workload);
+    }catch(const std::exception& e){
+        failures++;
+        cerr << "FAILED: " << e.what() << endl;
+    }
+    remove(workload.c_str());
+
+    if(failures>0){
+        cout << failures << " checks failed." << endl;
+        return 1;
+    }
+    cout << "All the checks passed." << endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file Aligner.cpp
+ */
+#include "Aligner.h"
+#include "SequentialImplementation.h"
+#include "ParallelCoarseOMPImplementation.h"
+#include "ParallelFineOMPImplementation.h"
+#include "SimdStripedImplementation.h"
+#include "LinearSpaceImplementation.h"
+#include "SimdBatchImplementation.h"
+#include "BitParallelImplementation.h"
+#include "ParallelHybridOMPImplementation.h"
+#include "ThreadPoolImplementation.h"
+#include "BandedImplementation.h"
+
+Aligner::Aligner(const Scores& scores, int engine, unsigned int threads) {
+    if(threads==0)
+        throw invalid_argument("Error. The number of threads must be a positive integer.");
+
+    //the versions are configured with the same arguments as in the command line, so they need no other constructor
+    vector<string> args = {"smith_waterman", "-memory",
+                           "-match", to_string(scores.matchScore),
+                           "-mismatch", to_string(scores.mismatchScore),
+                           "-gap", to_string(scores.gapScore),
+                           "-threads", to_string(threads)};
+    if(scores.maxAlignments>0){
+        args.push_back("-max-alignments");
+        args.push_back(to_string(scores.maxAlignments));
+    }
+    if(scores.collapseAlignments)
+        args.push_back("-collapse-alignments");
+    vector<char*> argv;
+    for(size_t i=0;i<args.size();i++)
+        argv.push_back(const_cast<char*>(args[i].c_str()));
+
+    this->engine = createEngine(engine, argv.size(), argv.data());
+    if(this->engine==0)
+        throw invalid_argument("Error. There is no version of the algorithm with number " + to_string(engine) + ".");
+}
+
+Aligner::~Aligner(void) {
+    delete engine;
+}
+
+void Aligner::align(const SequencePair* pairs, size_t count, vector<vector<Result>>& results){
+    results.assign(count, vector<Result>());
+    engine->alignBatch(pairs, count, [&results](size_t i, vector<Result>& pair_results){
+        results[i].swap(pair_results);  //every pair has its own vector, so the threads do not interfere
+    });
+}
+
+void Aligner::align(const SequencePair* pairs, size_t count, const function<void(size_t, vector<Result>&)>& callback){
+    engine->alignBatch(pairs, count, callback);
+}
+
+const Statistics& Aligner::getStatistics(void) const{
+    return engine->getStatistics();
+}
+
+Framework* Aligner::createEngine(int engine, int argc, char* argv[]){
+    switch(engine){
+        case SEQUENTIAL_IMPL: return new SequentialImplementation(argc, argv);
+        case PARALLEL_COARSE_IMPL: return new ParallelCoarseOMPImplementation(argc, argv);
+        case PARALLEL_FINE_IMPL: return new ParallelFineOMPImplementation(argc, argv);
+        case SIMD_STRIPED_IMPL: return new SimdStripedImplementation(argc, argv);
+        case LINEAR_SPACE_IMPL: return new LinearSpaceImplementation(argc, argv);
+        case SIMD_BATCH_IMPL: return new SimdBatchImplementation(argc, argv);
+        case BIT_PARALLEL_IMPL: return new BitParallelImplementation(argc, argv);
+        case PARALLEL_HYBRID_IMPL: return new ParallelHybridOMPImplementation(argc, argv);
+        case THREAD_POOL_IMPL: return new ThreadPoolImplementation(argc, argv);
+        case BANDED_IMPL: return new BandedImplementation(argc, argv);
+        default: return 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,225 @@
+/**
+ * @file BandedImplementation.cpp
+ */
+#include "BandedImplementation.h"
+#include "OptimumTracker.h"
+#include <unordered_map>
+
+BandedImplementation::BandedImplementation(int argc, char* argv[]):
+    Framework(argc, argv) {
+    band = -1;
+    for(int i=0;i<argc-1;i+=1){ //the band is optional
+        if(!string(argv[i]).compare("-band")){
+            if(atoi(argv[i+1])<0)
+                throw invalid_argument("Error. The band must be a non-negative integer.");
+            band = atoi(argv[i+1]);
+            break;
+        }
+    }
+    variant = band>=0 ? "band " + to_string(band) : string("adaptive band");  //the cache keeps them apart from the exact alignments
+
+    band_matrix.allocations = 0;
+    bandCells = 0;
+    matrixCells = 0;
+    pairBandCells = 0;
+    widenings = 0;
+    edgePairs = 0;
+    widestBand = 0;
+    statisticData.calcCellsTime = new long double[1];
+    statisticData.totalTracebackTime = new long double[1];
+    statisticData.calcCellsTime[0] = 0;
+    statisticData.totalTracebackTime[0] = 0;
+}
+
+BandedImplementation::~BandedImplementation() {
+    delete statisticData.calcCellsTime;
+    delete statisticData.totalTracebackTime;
+}
+
+int BandedImplementation::seed_diagonal(const Pair& sequences){
+    size_t rows = sequences.q.size(), columns = sequences.d.size();
+    if(rows<SEED_LENGTH || columns<SEED_LENGTH)
+        return 0;
+
+    //a seed is kept as the codes of its symbols (8 bits each, so the 8 symbols of a seed fill a 64-bit key)
+    unordered_map<uint64_t, size_t> seeds;  //the last position of every seed of Q
+    uint64_t key = 0;
+    for(size_t row=0;row<rows;row++){
+        key = (key<<8) | sequences.q[row];
+        if(row+1>=SEED_LENGTH)
+            seeds[key] = row;
+    }
+
+    unordered_map<int, unsigned int> votes;  //the number of seeds of D found on every diagonal
+    key = 0;
+    for(size_t col=0;col<columns;col++){
+        key = (key<<8) | sequences.d[col];
+        if(col+1<SEED_LENGTH)
+            continue;
+        unordered_map<uint64_t, size_t>::const_iterator seed = seeds.find(key);
+        if(seed!=seeds.end())
+            votes[(int)col - (int)seed->second]++;
+    }
+
+    int diagonal = 0;
+    unsigned int best = 0;
+    for(unordered_map<int, unsigned int>::const_iterator vote=votes.begin();vote!=votes.end();vote++){
+        if(vote->second>best || (vote->second==best && (abs(vote->first)<abs(diagonal) ||
+                                                        (abs(vote->first)==abs(diagonal) && vote->first<diagonal)))){
+            diagonal = vote->first;
+            best = vote->second;
+        }
+    }
+    return diagonal;
+}
+
+long long int BandedImplementation::fill_band(const Pair& sequences, BandMatrix& band_matrix, vector<Position>& max_pos){
+    int rows = sequences.q.size(), columns = sequences.d.size();
+    int low = band_matrix.low, high = band_matrix.high;
+    OptimumTracker tracker(algoScores.maxAlignments);
+    long long int cellsGreaterThanZero = 0;
+    vector<unsigned char> d(columns);  //the codes of the D sequence are unpacked once, since every row reads a part of them
+
+    for(int col=0;col<columns;col++)
+        d[col] = sequences.d[col];
+
+    for(int row=1;row<=rows;row++){ //row 0 and the cells outside of the band are zero
+        int* current = band_matrix[row];
+        const int* previous = band_matrix[row-1];
+        unsigned char symbol = sequences.q[row-1];
+        int first = std::max(1, row + low), last = std::min(columns, row + high);
+        for(int col=first;col<=last;col++){
+            int k = col - row - low;  //the cell up left is at the same diagonal, the cell above at the next one and the cell on the left at the previous one
+            int n1 = previous[k] + (symbol==d[col-1] ? algoScores.matchScore : algoScores.mismatchScore);
+            int n2 = previous[k+1] + algoScores.gapScore;
+            int n3 = current[k-1] + algoScores.gapScore;
+            int value = std::max(std::max(n1, n2), std::max(n3, 0));
+            current[k] = value;
+            bandCells++;
+            if(value==0)
+                continue;
+            cellsGreaterThanZero++;
+
+            //Search for the max value and save the Position x,y of max in the band
+            tracker.update(value, row, col);
+        }
+    }
+    tracker.collect(max_pos);
+    return cellsGreaterThanZero;
+}
+
+bool BandedImplementation::touches_edge(const Pair& sequences, const Result& result, Position end){
+    int lastLow = 1 - (int)sequences.q.size(), lastHigh = (int)sequences.d.size() - 1;  //the diagonals of the first and the last cells
+    int low = band_matrix.low, high = band_matrix.high;
+    int row = end.row, col = end.column;
+    const string& aligned_q = result.result_pair.q;
+    const string& aligned_d = result.result_pair.d;
+
+    for(size_t j=aligned_q.size();;j--){ //from the end of the alignment to its start
+        int diagonal = col - row;
+        if((diagonal==low && low>lastLow) || (diagonal==high && high<lastHigh))
+            return true;
+        if(j==0)
+            return false;
+        if(aligned_q[j-1]!='-')
+            row--;
+        if(aligned_d[j-1]!='-')
+            col--;
+    }
+}
+
+long long int BandedImplementation::pairCells(size_t i){
+    return pairBandCells;
+}
+
+void BandedImplementation::printStatistics(void){
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
+    cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
+    cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
+    cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
+    cout << "E) Total time of calculating cells: " << *statisticData.calcCellsTime << " seconds" << endl;
+    cout << "F) Total traceback time: " << *statisticData.totalTracebackTime << " seconds" << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellUpdates/(*statisticData.calcCellsTime) << endl;
+    cout << "I) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "J) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
+    if(band>=0)
+        cout << "K) Band: fixed, " << band << " diagonals at each side of the central one" << endl;
+    else
+        cout << "K) Band: adaptive, up to " << widestBand << " diagonals at each side of the central one (" << widenings << " widenings)" << endl;
+    cout << "L) Cells computed inside the bands: " << bandCells << " (" << (matrixCells>0 ? 100.0*bandCells/matrixCells : 0)
+         << "% of the scoring matrices)" << endl;
+    cout << "M) Pairs whose alignments touch the edge of the band: " << edgePairs << endl;
+}
+
+void BandedImplementation::alignPairs(void){
+    Result res;
+    long long int batchEdgePairs = 0;
+    long double time0 = getTime();
+	for(size_t i=0;i<data.size();i++){
+        vector<Position> max_pos_vec;
+		results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+
+        int rows = data[i].q.size(), columns = data[i].d.size();
+        long long int cells0 = bandCells;
+        matrixCells += (long long int)rows*columns;
+        int center = seed_diagonal(data[i]);
+        int width = band>=0 ? band : DEFAULT_BAND;
+        bool kept;
+        while(true){
+            PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+            band_matrix.reshape(rows+1, std::max(center - width, -rows), std::min(center + width, columns));
+            allocate.stop();
+            widestBand = std::max(widestBand, width);
+
+            long double time1 = getTime();
+            PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
+            statisticData.cellsGreaterThanZero += fill_band(data[i], band_matrix, max_pos_vec);
+            fill.stop();
+            pairBandCells = bandCells - cells0;  //the cells of all the bands of the pair
+            *statisticData.calcCellsTime += getTime() - time1;
+            int score = max_pos_vec.empty() ? 0 : band_matrix(max_pos_vec[0].row, max_pos_vec[0].column);
+            bool widest = band>=0 || (center - width<=-rows && center + width>=columns);  //the band cannot be widened any more
+            if(widest && !(kept = keepPair(i, score)))
+                break;
+
+            time1 = getTime();  //the clock is read once for all the tracebacks of the pair, since they are usually short
+            PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+            bool edge = false;
+            for(size_t j=0;j<max_pos_vec.size();j++){
+                res.ref_id = i;
+                res.score = band_matrix(max_pos_vec[j].row, max_pos_vec[j].column);
+                res.stop = max_pos_vec[j].column-1;
+                results[i].push_back(res);
+                statisticData.totalTracebackSteps += traceback(data[i], band_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
+                edge = edge || touches_edge(data[i], results[i].back(), max_pos_vec[j]);
+            }
+            tracebacks.stop();
+            *statisticData.totalTracebackTime += getTime() - time1;
+
+            if(edge && band>=0) //a fixed band, so the user is warned
+                batchEdgePairs++;
+            if(!edge || widest){
+                if(!widest) //the tracebacks of an adaptive band decide whether it is widened, so they precede the filter
+                    kept = keepPair(i, score);
+                break;
+            }
+            results[i].clear(); //the band is widened, and the pair is aligned again
+            width *= 2;
+            widenings++;
+        }
+        if(!kept){
+            results[i].clear();
+            continue;
+        }
+        completeResults(i);
+	}
+	statisticData.totalTime += getTime() - time0;
+	statisticData.matrixAllocations += band_matrix.allocations;
+    band_matrix.allocations = 0;
+    edgePairs += batchEdgePairs;
+    if(batchEdgePairs>0)
+        cerr << "Warning. The alignments of " << batchEdgePairs << " pairs touch the edge of the band, so a wider band might find better ones." << endl;
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+/**
+ * @file BatchReader.cpp
+ */
+#include "BatchReader.h"
+
+BatchReader::BatchReader(const string& path, size_t batchSize, Metrics* metrics):
+    buffer(BUFFER_SIZE), batchSize(batchSize), metrics(metrics) {
+    finished = false;
+    stopping = false;
+
+    input.rdbuf()->pubsetbuf(&buffer[0], buffer.size());  //must precede open() to take effect
+    input.open(path.c_str());
+    if(!input.is_open())
+        throw ios_base::failure("Input file cannot be opened.");
+    worker = thread(&BatchReader::run, this);
+}
+
+BatchReader::~BatchReader(void) {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    taken.notify_one();
+    worker.join();
+
+    for(size_t i=0;i<queue.size();i++)
+        delete queue[i];
+}
+
+PairBatch* BatchReader::next(void){
+    unique_lock<mutex> guard(lock);
+    PairBatch* batch;
+
+    parsed.wait(guard, [this]{ return finished || !queue.empty(); });
+    if(queue.empty()){ //the whole file has been parsed
+        if(error)
+            rethrow_exception(error);
+        return 0;
+    }
+    batch = queue.front();
+    queue.pop_front();
+    taken.notify_one();
+    return batch;
+}
+
+bool BatchReader::push(PairBatch* batch){
+    unique_lock<mutex> guard(lock);
+
+    taken.wait(guard, [this]{ return stopping || queue.size()<MAX_QUEUED; });
+    if(stopping){
+        delete batch;
+        return false;
+    }
+    queue.push_back(batch);
+    parsed.notify_one();
+    return true;
+}
+
+void BatchReader::run(void){
+    if(metrics)
+        metrics->setThreadName("reader");
+    PairBatch* batch = 0;
+    string symbols;  //the symbols of all the sequences of the batch, before they are packed
+    vector<size_t> bounds;  //for every pair of the batch, the end of its Q and the end of its D sequence inside the symbols
+    vector<string_view> sequences;
+    vector<PackedSequence> packed;
+    string token;
+    size_t index = 0;
+    bool more;
+
+    try{
+        more = static_cast<bool>(input >> token);  //"Q:" string of 1st pair
+        while(more){  //While not reached EOF, continue reading the next pair
+            PhaseTimer timer(metrics, PARSE_PHASE);
+            if(token!="Q:")  //1st sequence of a pair not starting with "Q:"
+                throw runtime_error("Error: Invalid file contents...");
+            if(batch==0){
+                batch = new PairBatch();
+                batch->first = index;
+                symbols.clear();
+                bounds.clear();
+            }
+
+            while(true){  //While not found "D:", we are still reading q
+                if(!(input >> token))  //EOF found before "D:" --> error
+                    throw runtime_error("Error: Invalid file contents...");
+                if(token=="D:")
+                    break;
+                symbols += token;
+            }
+            bounds.push_back(symbols.size());
+            while((more = static_cast<bool>(input >> token)) && token!="Q:")  //While not found EOF or "Q:" of the next pair, we are still reading d
+                symbols += token;
+            bounds.push_back(symbols.size());
+            index++;
+
+            if(bounds.size()==2*batchSize || !more){ //the symbols are complete, so they can be packed
+                size_t begin = 0;
+                sequences.clear();
+                for(size_t k=0;k<bounds.size();k++){
+                    sequences.push_back(string_view(symbols.data() + begin, bounds[k] - begin));
+                    begin = bounds[k];
+                }
+                batch->store.pack(sequences, packed);
+                batch->pairs.resize(packed.size()/2);
+                for(size_t k=0;k<batch->pairs.size();k++){
+                    batch->pairs[k].q = packed[2*k];
+                    batch->pairs[k].d = packed[2*k+1];
+                }
+                timer.stop();  //the time waiting for the batch to be taken is not parsing
+                if(!push(batch))
+                    return;
+                batch = 0;
+            }
+        }
+    }catch(...){
+        delete batch;
+        lock_guard<mutex> guard(lock);
+        error = current_exception();
+    }
+
+    lock_guard<mutex> guard(lock);
+    finished = true;
+    parsed.notify_one();
+}
@@ -0,0 +1,246 @@
+/**
+ * @file BitParallelImplementation.cpp
+ */
+#include "BitParallelImplementation.h"
+#include "OptimumTracker.h"
+#include <algorithm>
+#include <limits.h>
+
+BitParallelImplementation::BitParallelImplementation(int argc, char* argv[]):
+    Framework(argc, argv) {
+    statisticData.calcCellsTime = new long double[1];
+    statisticData.totalTracebackTime = new long double[1];
+    statisticData.calcCellsTime[0] = 0;
+    statisticData.totalTracebackTime[0] = 0;
+    scalarPairs = 0;
+    maskSets = 0;
+    if(algoScores.gapScore!=0 || algoScores.mismatchScore>0 || algoScores.matchScore<=0)
+        cerr << "Warning. The bit-parallel kernel needs a gap score of 0, a mismatch score of at most 0 and a positive match score, "
+             << "so every pair will be computed cell by cell (slower than the sequential version)." << endl;
+}
+
+BitParallelImplementation::~BitParallelImplementation() {
+    delete statisticData.calcCellsTime;
+    delete statisticData.totalTracebackTime;
+}
+
+bool BitParallelImplementation::bit_parallel_scores(const Pair& sequences){
+    //a gap costs nothing, so a mismatch is never better than skipping a symbol, and the matrix counts the matched symbols
+    if(algoScores.gapScore!=0 || algoScores.mismatchScore>0 || algoScores.matchScore<=0)
+        return false;
+    return (long long int)algoScores.matchScore*min(sequences.q.size(), sequences.d.size())<INT_MAX;
+}
+
+void BitParallelImplementation::build_masks(const PackedSequence& q, unsigned int words){
+    //the masks depend only on the Q sequence, so they are reused by consecutive pairs with the same Q (e.g. a database search)
+    if(maskSets>0 && q==maskQuery)
+        return;
+
+    masks.clear();
+    for(int i=0;i<256;i++)
+        maskIndex[i] = -1;
+    for(size_t i=0;i<q.size();i++){
+        unsigned char symbol = q.symbol(i);
+        if(maskIndex[symbol]<0){
+            maskIndex[symbol] = masks.size();
+            masks.resize(masks.size() + words, 0);
+        }
+        masks[maskIndex[symbol] + i/64] |= 1ULL<<(i%64);
+    }
+    noMatches.assign(words, 0);
+    maskQuery = q.str();
+    maskSets++;
+}
+
+long long int BitParallelImplementation::fill_scoring_matrix(const Pair& sequences, BitScoringMatrix& scoring_matrix, vector<Position>& max_pos){
+    const size_t rows = sequences.q.size(), columns = sequences.d.size();
+    const unsigned int words = (rows + 63)/64;
+    const uint64_t lastWord = rows%64==0 ? ~0ULL : (1ULL<<(rows%64)) - 1;  //the bits of the last word which correspond to rows
+    const size_t total = (size_t)(columns+1)*words;
+    vector<unsigned int> columnLcs(columns+1, 0), firstRow(columns+1, 0);
+    long long int cellsGreaterThanZero = 0;
+    unsigned int lcs;
+
+    max_pos.clear();
+    scoring_matrix.rows = rows+1;
+    scoring_matrix.columns = columns+1;
+    scoring_matrix.words = words;
+    scoring_matrix.matchScore = algoScores.matchScore;
+    PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+    scoring_matrix.bits = (uint64_t*)scoring_matrix.arena.reserve(total*(sizeof(uint64_t) + sizeof(uint32_t)));
+    allocate.stop();
+    scoring_matrix.counts = (uint32_t*)(scoring_matrix.bits + total);
+    build_masks(sequences.q, words);
+
+    for(unsigned int w=0;w<words;w++){ //column 0, where nothing is matched
+        scoring_matrix.bits[w] = ~0ULL;
+        scoring_matrix.counts[w] = 0;
+    }
+
+    for(size_t col=1;col<=columns;col++){ //for every column of scoring matrix
+        unsigned char symbol = sequences.d.symbol(col-1);
+        const uint64_t* match = maskIndex[symbol]<0 ? noMatches.data() : masks.data() + maskIndex[symbol];
+        const uint64_t* prevColumn = &scoring_matrix.bits[(col-1)*words];
+        uint64_t* column = &scoring_matrix.bits[col*words];
+        uint32_t* count = &scoring_matrix.counts[col*words];
+        uint64_t carry = 0;
+        uint32_t zeros = 0;
+
+        //V' = (V + U) | (V - U) with U = V & match, where the addition carries from every word to the next one
+        for(unsigned int w=0;w<words;w++){
+            uint64_t v = prevColumn[w], u = v & match[w];
+            uint64_t sum = v + u;
+            uint64_t overflow = sum<v;
+            sum += carry;
+            overflow |= sum<carry;
+            carry = overflow;
+
+            column[w] = sum | (v - u);
+            count[w] = zeros;
+            zeros += __builtin_popcountll(~column[w] & (w==words-1 ? lastWord : ~0ULL));
+        }
+        columnLcs[col] = zeros;
+
+        //How many cells have value>0, i.e. all the rows from the first match of the column downwards
+        for(unsigned int w=0;w<words;w++){
+            uint64_t matched = ~column[w] & (w==words-1 ? lastWord : ~0ULL);
+            if(matched){
+                cellsGreaterThanZero += rows - ((size_t)w*64 + __builtin_ctzll(matched));
+                break;
+            }
+        }
+    }
+
+    //the LCS never decreases to the right or downwards, so the max value is in the last cell, and in every row it is reached
+    //by a suffix of the columns that only grows from one row to the next
+    PhaseTimer scan(metrics, MAX_SCAN_PHASE);
+    lcs = columnLcs[columns];
+    if(lcs==0) //nothing to align
+        return cellsGreaterThanZero;
+    for(size_t col=1;col<=columns;col++){
+        if(columnLcs[col]<lcs)
+            continue;
+        const uint32_t* count = &scoring_matrix.counts[col*words];
+        unsigned int w = lower_bound(count, count + words, lcs) - count - 1;  //the word with the last match of the column
+        uint64_t matched = ~scoring_matrix.bits[col*words + w] & (w==words-1 ? lastWord : ~0ULL);
+        for(unsigned int k=count[w]+1;k<lcs;k++)
+            matched &= matched - 1;
+        firstRow[col] = w*64 + __builtin_ctzll(matched) + 1;
+    }
+
+    //Save the cells with the max value in row-major order like the other implementations
+    OptimumTracker tracker(algoScores.maxAlignments);
+    size_t firstColumn = columns+1;
+    for(size_t row=firstRow[columns];row<=rows;row++){
+        while(firstColumn>1 && firstRow[firstColumn-1]!=0 && firstRow[firstColumn-1]<=row)
+            firstColumn--;
+        for(size_t col=firstColumn;col<=columns;col++)
+            tracker.update(lcs*algoScores.matchScore, row, col);
+    }
+    tracker.collect(max_pos);
+    return cellsGreaterThanZero;
+}
+
+long long int BitParallelImplementation::fill_scoring_matrix_scalar(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos){
+	int n1, n2, n3;
+	OptimumTracker tracker(algoScores.maxAlignments);
+	long long int cellsGreaterThanZero=0;
+
+	for(size_t row=0;row<scoring_matrix.size();row++){ //for every row of scoring matrix
+		for(size_t col=0;col<scoring_matrix.columns();col++){ //for every column of scoring matrix
+			if((row==0) || (col==0)){
+				scoring_matrix[row][col] = 0;
+			}
+			else{
+				//compute the cell for match, mismatch and gap
+				if(sequences.q[row-1]==sequences.d[col-1])
+					n1 = scoring_matrix[row-1][col-1] + algoScores.matchScore;
+				else
+					n1 = scoring_matrix[row-1][col-1] + algoScores.mismatchScore;
+				n2 = scoring_matrix[row-1][col] + algoScores.gapScore;
+				n3 = scoring_matrix[row][col-1] + algoScores.gapScore;
+
+				scoring_matrix[row][col] = max(max(0, n1), max(n2, n3));
+			}
+			//How many cells have value>0
+			if(scoring_matrix[row][col]>0)
+				cellsGreaterThanZero++;
+
+			//Search for the max value and save the Position x,y of max i matrix
+			tracker.update(scoring_matrix[row][col], row, col);
+		}
+	}
+	tracker.collect(max_pos);
+	return cellsGreaterThanZero;
+}
+
+void BitParallelImplementation::printStatistics(void){
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
+    cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
+    cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
+    cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
+    cout << "E) Total time of calculating cells: " << *statisticData.calcCellsTime << " seconds" << endl;
+    cout << "F) Total traceback time: " << *statisticData.totalTracebackTime << " seconds" << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellUpdates/(*statisticData.calcCellsTime) << endl;
+    cout << "I) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "J) Pairs computed without the bit-parallel kernel: " << scalarPairs << endl;
+    cout << "K) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
+    cout << "L) Match masks built: " << maskSets << endl;
+}
+
+void BitParallelImplementation::alignPairs(void){
+    Result res;
+    BitScoringMatrix bit_matrix;  //both matrices are reused for every pair
+    ScoringMatrix scoring_matrix;
+    long double time0 = getTime();
+
+	for(size_t i=0;i<data.size();i++){
+        vector<Position> max_pos_vec;
+		results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+
+		long double time1 = getTime();
+        PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
+        bool bits = bit_parallel_scores(data[i]);
+        if(bits)
+            statisticData.cellsGreaterThanZero += fill_scoring_matrix(data[i], bit_matrix, max_pos_vec);
+        else{
+            PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+            scoring_matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+            allocate.stop();
+            statisticData.cellsGreaterThanZero += fill_scoring_matrix_scalar(data[i], scoring_matrix, max_pos_vec);
+            scalarPairs++;
+        }
+        fill.stop();
+		*statisticData.calcCellsTime += getTime() - time1;
+        int score = 0;
+        if(!max_pos_vec.empty())
+            score = bits ? bit_matrix(max_pos_vec[0].row, max_pos_vec[0].column) : scoring_matrix[max_pos_vec[0].row][max_pos_vec[0].column];
+        if(!keepPair(i, score))
+            continue;
+
+        time1 = getTime();  //the clock is read once for all the tracebacks of the pair, since they are usually short
+        PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+		for(size_t j=0;j<max_pos_vec.size();j++){
+            res.ref_id = i;
+			res.stop = max_pos_vec[j].column-1;
+			results[i].push_back(res);
+
+            if(bits){
+                results[i].back().score = bit_matrix(max_pos_vec[j].row, max_pos_vec[j].column);
+                statisticData.totalTracebackSteps += traceback(data[i], bit_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
+            }
+            else{
+                results[i].back().score = scoring_matrix[max_pos_vec[j].row][max_pos_vec[j].column];
+                statisticData.totalTracebackSteps += traceback(data[i], scoring_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
+            }
+		}
+        tracebacks.stop();
+		*statisticData.totalTracebackTime += getTime() - time1;
+        completeResults(i);
+	}
+	statisticData.totalTime += getTime() - time0;
+	statisticData.matrixAllocations += bit_matrix.arena.getAllocations() + scoring_matrix.getAllocations();
+}
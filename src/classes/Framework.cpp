@@ -2,12 +2,32 @@
  * @file Framework.cpp
  */
 #include "Framework.h"
+#include "ResultCache.h"
+#include "ReportWriter.h"
+#include "BatchReader.h"
+#include "InputFile.h"
+#include <unordered_set>
 
 Framework::Framework(int argc, char* argv[]) {
+    topResults = 0;
+    batchSize = 0;
+    cacheSize = DEFAULT_CACHE_SIZE;
+    inMemory = false;
+    consumer = 0;
+    minScore = 0;
+    topK = 0;
+    algoScores.maxAlignments = 0;
+    algoScores.collapseAlignments = false;
     if(argc<=1)
         readArgsFromConsole();
     else{ //the user provided the arguments, so initialize with them
-        bool argName = false, argPath = false, argMatch = false, argMismatch = false, argGap = false;
+        bool argName = false, argPath = false, argMatch = false, argMismatch = false, argGap = false, argQuery = false, argDatabase = false;
+        for(int i=0;i<argc;i++){ //flags without value, so they may also be the last argument
+            if(!string(argv[i]).compare("-memory"))
+                inMemory = true;
+            else if(!string(argv[i]).compare("-collapse-alignments"))
+                algoScores.collapseAlignments = true;
+        }
         for(int i=0;i<argc-1;i+=1){
             if(!string(argv[i]).compare("-id")){
                 reportId = string(argv[i+1]);
@@ -29,52 +49,289 @@ Framework::Framework(int argc, char* argv[]) {
                 algoScores.gapScore = atoi(argv[i+1]);
                 argGap = true;
             }
+            else if(!string(argv[i]).compare("-cache"))
+                cachePath = string(argv[i+1]);
+            else if(!string(argv[i]).compare("-cache-size")){
+                if(atoi(argv[i+1])<0)
+                    throw invalid_argument("Error. The size of the cache must be a non-negative integer.");
+                cacheSize = atoi(argv[i+1]);
+            }
+            else if(!string(argv[i]).compare("-metrics"))
+                metricsPath = string(argv[i+1]);
+            else if(!string(argv[i]).compare("-trace"))
+                tracePath = string(argv[i+1]);
+            else if(!string(argv[i]).compare("-query")){
+                queryPath = string(argv[i+1]);
+                argQuery = true;
+            }
+            else if(!string(argv[i]).compare("-db")){
+                databasePath = string(argv[i+1]);
+                argDatabase = true;
+            }
+            else if(!string(argv[i]).compare("-top")){
+                if(atoi(argv[i+1])<=0)
+                    throw invalid_argument("Error. The number of top results must be a positive integer.");
+                topResults = atoi(argv[i+1]);
+            }
+            else if(!string(argv[i]).compare("-min-score")){
+                if(atoi(argv[i+1])<=0)
+                    throw invalid_argument("Error. The minimum score must be a positive integer.");
+                minScore = atoi(argv[i+1]);
+            }
+            else if(!string(argv[i]).compare("-top-k")){
+                if(atoi(argv[i+1])<=0)
+                    throw invalid_argument("Error. The number of best pairs must be a positive integer.");
+                topK = atoi(argv[i+1]);
+            }
+            else if(!string(argv[i]).compare("-max-alignments")){
+                if(atoi(argv[i+1])<=0)
+                    throw invalid_argument("Error. The maximum number of alignments must be a positive integer.");
+                algoScores.maxAlignments = atoi(argv[i+1]);
+            }
+            else if(!string(argv[i]).compare("-batch")){
+                if(atoi(argv[i+1])<=0)
+                    throw invalid_argument("Error. The size of a batch must be a positive integer.");
+                batchSize = atoi(argv[i+1]);
+            }
             else
                 continue;
         }
 
-        if(!argName || !argPath || !argMatch || !argMismatch || !argGap)
+        if((!inMemory && (!argName || !(argPath || (argQuery && argDatabase)))) || !argMatch || !argMismatch || !argGap)
             throw invalid_argument("Error. Missing arguments.");
+        if(inMemory){ //the pairs are given by #alignBatch(), so none of the files is used
+            path.clear();
+            queryPath.clear();
+            batchSize = 0;
+        }
+        if(batchSize>0 && !queryPath.empty())
+            throw invalid_argument("Error. A database search cannot be pipelined.");
+        if(batchSize>0 && topK>0)
+            throw invalid_argument("Error. The best pairs cannot be selected in a pipelined execution.");
+    }
+
+    reader = 0;
+    currentBatch = 0;
+    previousBatch = 0;
+    metrics = metricsPath.empty() && tracePath.empty() ? 0 : new Metrics(!tracePath.empty());
+    try{
+        if(batchSize>0)
+            reader = new BatchReader(path, batchSize, metrics); //the batches are read in the background, while runAlgorithm() aligns them
+        else if(!queryPath.empty())
+            readDatabaseFiles(); //read the query and the database of a database search
+        else if(!inMemory)
+            readInputFile(); //read the sequences for alignment from the input file
+    }catch(...){
+        delete metrics;
+        throw;
     }
 
-	readInputFile(); //read the sequences for alignment from the input file
+    cache = new ResultCache(cacheSize);
+    writer = 0;
+    try{
+        if(!cachePath.empty())
+            cache->load(cachePath);
+        if(queryPath.empty() && !inMemory) //the report is written while the pairs are aligned (a database search has to rank them first)
+            writer = new ReportWriter(string("reports/Report_") + reportId + string(".txt"), metrics);
+    }catch(...){
+        delete cache;
+        delete reader;
+        delete metrics;
+        throw;
+    }
 
-	for(size_t i=0;i<data.size();i++) //initialize the results vector
-        results.push_back(vector<Result>());
+    firstPair = 0;
+    totalPairs = data.size();
+    selectedPairs = 0;
+    filteredPairs = 0;
+    scoring = false;
+    results.assign(data.size(), vector<Result>()); //initialize the results vector
 
     statisticData.cellsGreaterThanZero = 0; //Initialize the object holding the statistical data
+    statisticData.cellUpdates = 0;
     statisticData.totalTracebackSteps = 0;
     statisticData.totalTime = 0;
     statisticData.calcCellsTime = 0;
     statisticData.totalTracebackTime = 0;
+    statisticData.matrixAllocations = 0;
+}
+
+Framework::~Framework() {
+    delete reader;
+    delete writer; //it writes the pairs that were handed over, so their batches are released afterwards
+    delete currentBatch;
+    delete previousBatch;
+    delete cache;
+    delete metrics; //after the reader and the writer, whose threads measure their phases
+}
+
+void Framework::runAlgorithm(void){
+    if(reader==0){ //all the pairs have been read
+        filterPairs();
+        alignWindows();
+        return;
+    }
+
+    for(PairBatch* batch=reader->next();batch!=0;batch=reader->next()){
+        if(previousBatch!=0){ //the pairs of the batch before the previous one are no longer needed after they are written
+            writer->wait(firstPair);
+            delete previousBatch;
+        }
+        previousBatch = currentBatch;
+        currentBatch = batch;
+
+        data.swap(batch->pairs);
+        totalPairs += data.size();
+        filterPairs();
+        alignWindows(); //the cache is bounded by its size, so it keeps the identical pairs of the earlier batches too
+    }
 }
 
-Framework::~Framework() {}
+void Framework::alignWindows(void){
+    if(writer==0 || data.size()<=WINDOW_PAIRS){
+        results.assign(data.size(), vector<Result>());
+        alignPairs();
+        return;
+    }
+
+    //the versions may finish the pairs of a window in any order, but the writer never waits for a pair of a later window
+    vector<Pair> pairs;
+    pairs.swap(data);
+    size_t base = firstPair;
+    try{
+        for(size_t w=0;w<pairs.size();w+=WINDOW_PAIRS){
+            data.assign(pairs.begin() + w, pairs.begin() + min(w + WINDOW_PAIRS, pairs.size()));
+            firstPair = base + w;
+            results.assign(data.size(), vector<Result>());
+            alignPairs();
+        }
+    }catch(...){
+        firstPair = base;
+        data.swap(pairs);
+        throw;
+    }
+    firstPair = base;
+    data.swap(pairs);
+}
 
 long double Framework::getTime(void){
-	struct timeval ttime;
-	gettimeofday(&ttime, 0);
-	return (ttime.tv_sec+ttime.tv_usec*0.000001);
+	return Metrics::now();
+}
+
+void Framework::alignBatch(const SequencePair* pairs, size_t count, const function<void(size_t, vector<Result>&)>& consumer){
+    if(!inMemory)
+        throw logic_error("Error. The pairs of this execution are read from the input file.");
+
+    PhaseTimer timer(metrics, PARSE_PHASE);
+    vector<string_view> symbols(2*count); //the Q and the D sequence of every pair, before they are packed
+    vector<PackedSequence> packed;
+    for(size_t i=0;i<count;i++){
+        symbols[2*i] = pairs[i].q;
+        symbols[2*i+1] = pairs[i].d;
+    }
+    sequenceStore.pack(symbols, packed); //the sequences of the previous batch are released
+    data.resize(count);
+    for(size_t i=0;i<count;i++){
+        data[i].q = packed[2*i];
+        data[i].d = packed[2*i+1];
+    }
+    timer.stop();
+
+    totalPairs += count;
+    filterPairs();
+    results.assign(data.size(), vector<Result>());
+    this->consumer = &consumer;
+    try{
+        alignPairs();
+    }catch(...){
+        this->consumer = 0;
+        throw;
+    }
+    this->consumer = 0;
 }
 
 void Framework::printResultsToFile(void){
+    if(inMemory)
+        return;
+    if(writer!=0){ //the pairs have already been handed over to the writer, so wait for them to be written
+        writer->close();
+        return;
+    }
+
+    PhaseTimer timer(metrics, WRITE_PHASE);
     ofstream output;
+    vector<char> buffer(ReportWriter::BUFFER_SIZE);
+    output.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
     output.open ((string("reports/Report_") + reportId + string(".txt")).c_str());
 	if(!output.is_open())
 		throw ios_base::failure((string("Output file reports/Report_") + reportId + string(".txt cannot be opened.")).c_str());
 
+    //a database search, so the best D sequences come first
+    vector<size_t> order(results.size());
+    for(size_t i=0;i<results.size();i++)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b){
+        int score_a = results[a].empty() ? 0 : results[a][0].score;
+        int score_b = results[b].empty() ? 0 : results[b][0].score;
+        return score_a>score_b;
+    });
+    while(!order.empty() && (results[order.back()].empty() ? 0 : results[order.back()][0].score)<minScore)
+        order.pop_back(); //the pairs that did not pass the filter are the last ones, since their scores are the lowest
+    if(topResults>0 && topResults<order.size())
+        order.resize(topResults);
 
-    for(size_t i=0;i<results.size();i++){
-        output << "Q: " << data[i].q << endl;
-        output << "D: " << data[i].d << endl;
+    for(size_t k=0;k<order.size();k++)
+        ReportWriter::write_pair(output, data[order[k]], results[order[k]]);
+    output.close();
+}
 
-        for(size_t j=0;j<results[i].size();j++){
-            output << "Match " << j+1 << " [Score: " << results[i][j].score << ", Start: " << results[i][j].start << ", Stop: " << results[i][j].stop << "]" << endl;
-            output << "	D: " << results[i][j].result_pair.d << endl;
-            output << "	Q: " << results[i][j].result_pair.q << endl;
+void Framework::filterPairs(void){
+    firstPair = selectedPairs;
+    selection.clear();
+    if(topK>0){
+        //the scores come from the kernel of the version, which skips every traceback while the pairs are scored
+        scores.assign(data.size(), 0);
+        results.assign(data.size(), vector<Result>());
+        scoring = true;
+        try{
+            alignPairs();
+        }catch(...){
+            scoring = false;
+            throw;
         }
+        scoring = false;
+
+        //a pair is better than another if it has a greater score, or the same score and an earlier index,
+        //so the top of the heap is the worst of the best pairs found so far
+        auto better = [this](size_t a, size_t b){
+            return scores[a]>scores[b] || (scores[a]==scores[b] && a<b);
+        };
+        for(size_t i=0;i<data.size();i++){
+            if(scores[i]<minScore)
+                continue;
+            if(selection.size()<topK){
+                selection.push_back(i);
+                push_heap(selection.begin(), selection.end(), better);
+            }
+            else if(better(i, selection.front())){ //it replaces the worst of the best pairs
+                pop_heap(selection.begin(), selection.end(), better);
+                selection.back() = i;
+                push_heap(selection.begin(), selection.end(), better);
+            }
+        }
+        sort(selection.begin(), selection.end()); //the pairs are aligned and reported in the input order
+        vector<int>().swap(scores);
+
+        filteredPairs += data.size() - selection.size();
+        if(selection.size()<data.size()){
+            for(size_t k=0;k<selection.size();k++)
+                data[k] = data[selection[k]];
+            data.resize(selection.size());
+        }
+        else
+            selection.clear();
     }
-    output.close();
+    selectedPairs += data.size();
 }
 
 void Framework::readArgsFromConsole(void){
@@ -100,44 +357,198 @@ void Framework::readArgsFromConsole(void){
 }
 
 void Framework::readInputFile(void){
-	ifstream input;
-	string tmp_string;
-	Pair qd_pair;
+	PhaseTimer timer(metrics, PARSE_PHASE);
+	InputFile inputFile;
+	vector<string_view> symbols; //the Q and the D sequence of every pair, before they are packed
+	vector<PackedSequence> packed;
+	string_view token, q, d;
 
-	input.open((this->path).c_str()); //Open the file with the input data
-	if(!input.is_open()){
-		input.close();
+	if(!inputFile.open(path)) //Map the file with the input data
 		throw ios_base::failure("Input file cannot be opened.");
-	}
-	else{  //File opened
-		input >> tmp_string;  //"Q:" string of 1st pair
-		while(!input.eof()){  //While not reached EOF, continue reading the next pair
-			if(tmp_string.compare("Q:")){  //1st sequence of a pair not starting with "Q:"
-                input.close();
+
+	token = inputFile.next_token();  //"Q:" string of 1st pair
+	while(!token.empty()){  //While not reached EOF, continue reading the next pair
+		if(token!="Q:")  //1st sequence of a pair not starting with "Q:"
+			throw runtime_error("Error: Invalid file contents...");
+
+		q = string_view();
+		d = string_view();
+		token = inputFile.next_token();
+		while(token!="D:"){  //While not found "D:", we are still reading q
+			if(token.empty())  //EOF found before "D:" --> error
 				throw runtime_error("Error: Invalid file contents...");
-			}
-			else{  //1st sequence starts with "Q:" - all good
-				while(tmp_string.compare("D:")){  //While not found "D:", continue reading
-					if(input.eof()){  //EOF found before "D:" --> error
-						input.close();
-                        throw runtime_error("Error: Invalid file contents...");
-					}
-
-					input >> tmp_string;
-					if(tmp_string.compare("D:")) //if not found "D:", we are still reading q
-						qd_pair.q += tmp_string;
-				}
-				while(tmp_string.compare("Q:") && !input.eof()){ //While not found EOF or "Q:" of the next pair, continue reading
-					tmp_string = "";
-					input >> tmp_string;
-					if(tmp_string.compare("Q:")) //if not found "Q:", we are still reading d
-						qd_pair.d += tmp_string;
-				}
-				data.push_back(qd_pair); //push the data to the vector
-				qd_pair.q.clear();
-				qd_pair.d.clear();
-			}
+			q = inputFile.concatenate(q, token);
+			token = inputFile.next_token();
+		}
+		token = inputFile.next_token();
+		while(!token.empty() && token!="Q:"){ //While not found EOF or "Q:" of the next pair, we are still reading d
+			d = inputFile.concatenate(d, token);
+			token = inputFile.next_token();
+		}
+		symbols.push_back(q);
+		symbols.push_back(d);
+	}
+
+	//the sequences are packed, so the memory of the file is released when this method returns
+	sequenceStore.pack(symbols, packed);
+	data.resize(packed.size()/2);
+	for(size_t i=0;i<data.size();i++){
+		data[i].q = packed[2*i];
+		data[i].d = packed[2*i+1];
+	}
+}
+
+void Framework::readDatabaseFiles(void){
+	PhaseTimer timer(metrics, PARSE_PHASE);
+	InputFile inputFile, databaseFile;
+	vector<string_view> symbols; //the Q sequence and then every D sequence, before they are packed
+	vector<PackedSequence> packed;
+	string_view token, query, d;
+	bool inSequence = false;
+
+	if(!inputFile.open(queryPath)) //Map the file with the Q sequence
+		throw ios_base::failure("Query file cannot be opened.");
+	token = inputFile.next_token();  //"Q:" string of the sequence
+	if(token!="Q:")
+		throw runtime_error("Error: Invalid query file contents...");
+	for(token=inputFile.next_token();!token.empty();token=inputFile.next_token()){  //the rest of the file is the Q sequence
+		if(token=="Q:")
+			throw runtime_error("Error: The query file must contain a single sequence...");
+		query = inputFile.concatenate(query, token);
+	}
+	symbols.push_back(query);
+
+	if(!databaseFile.open(databasePath)) //Map the file with the D sequences
+		throw ios_base::failure("Database file cannot be opened.");
+	for(token=databaseFile.next_token();!token.empty();token=databaseFile.next_token()){  //every "D:" string begins the next D sequence
+		if(token=="D:"){
+			if(inSequence)
+				symbols.push_back(d);
+			d = string_view();
+			inSequence = true;
 		}
-		input.close();  //close the ifstream
+		else if(!inSequence)  //symbols before the first "D:"
+			throw runtime_error("Error: Invalid database file contents...");
+		else
+			d = databaseFile.concatenate(d, token);
+	}
+	if(inSequence)
+		symbols.push_back(d);
+
+	//all the pairs share the same (packed) Q sequence
+	sequenceStore.pack(symbols, packed);
+	data.resize(packed.size()-1);
+	for(size_t i=0;i<data.size();i++){
+		data[i].q = packed[0];
+		data[i].d = packed[i+1];
 	}
 }
+
+void Framework::saveCache(void){
+    if(!cachePath.empty())
+        cache->save(cachePath);
+}
+
+void Framework::saveMetrics(void){
+    if(!tracePath.empty())
+        metrics->saveTrace(tracePath);
+    if(metricsPath.empty())
+        return;
+    metrics->set("pairs", totalPairs);
+    metrics->set("total_seconds", statisticData.totalTime);
+    metrics->set("cell_updates", statisticData.cellUpdates);
+    metrics->set("gcups", statisticData.totalTime>0 ? statisticData.cellUpdates/statisticData.totalTime/1e9 : 0);
+    metrics->set("cells_greater_than_zero", statisticData.cellsGreaterThanZero);
+    metrics->set("traceback_steps", statisticData.totalTracebackSteps);
+    metrics->set("matrix_allocations", statisticData.matrixAllocations);
+    metrics->set("cache_hits", getCacheHits());
+    metrics->set("cache_misses", getCacheMisses());
+    metrics->set("filtered_pairs", filteredPairs);
+    metrics->save(metricsPath);
+}
+
+bool Framework::reuseResults(size_t i){
+    if(!cache->find(data[i], algoScores, variant, i, results[i]))
+        return false;
+    if(passFilters(i, results[i].empty() ? 0 : results[i][0].score))
+        writeResults(i);
+    else
+        results[i].clear();
+    return true;
+}
+
+bool Framework::keepPair(size_t i, int score){
+    if(passFilters(i, score))
+        return true;
+    statisticData.cellUpdates += pairCells(i); //the scoring matrix was filled anyway
+    return false;
+}
+
+long long int Framework::pairCells(size_t i){
+    return (long long int)data[i].q.size()*data[i].d.size();
+}
+
+bool Framework::passFilters(size_t i, int score){
+    if(scoring){
+        scores[i] = score; //every pair has its own entry, so no locking is needed
+        return false;
+    }
+    if(score>=minScore)
+        return true;
+    filteredPairs++;
+    if(writer!=0) //the report continues with the next pair
+        writer->skip(firstPair + i);
+    return false;
+}
+
+void Framework::completeResults(size_t i){
+    if(algoScores.collapseAlignments && results[i].size()>1){
+        //the first of the identical alignments is kept, so the order of the report does not change
+        vector<Result>& pair_results = results[i];
+        auto hash = [&pair_results](size_t k){
+            const Result& res = pair_results[k];
+            size_t h = std::hash<string>()(res.result_pair.q)*31 + std::hash<string>()(res.result_pair.d);
+            return (h*31 + (size_t)res.start)*31 + (size_t)res.stop;
+        };
+        auto equal = [&pair_results](size_t a, size_t b){
+            const Result& x = pair_results[a];
+            const Result& y = pair_results[b];
+            return x.score==y.score && x.start==y.start && x.stop==y.stop &&
+                   x.result_pair.q==y.result_pair.q && x.result_pair.d==y.result_pair.d;
+        };
+        unordered_set<size_t, decltype(hash), decltype(equal)> distinct(2*pair_results.size(), hash, equal);  //the indices of the kept alignments
+        size_t kept = 0;
+        for(size_t j=0;j<pair_results.size();j++){
+            if(kept<j) //the alignments between them are duplicates, so they are overwritten
+                pair_results[kept] = move(pair_results[j]);
+            if(distinct.insert(kept).second)
+                kept++;
+        }
+        pair_results.resize(kept);
+    }
+    statisticData.cellUpdates += pairCells(i);
+    cache->insert(data[i], algoScores, variant, results[i]);
+    writeResults(i);
+}
+
+void Framework::writeResults(size_t i){
+    if(writer!=0){ //the alignments are moved to the writer, so they do not stay in memory
+        vector<Result> pair_results;
+        pair_results.swap(results[i]);
+        writer->write(firstPair + i, data[i], move(pair_results));
+    }
+    else if(consumer!=0)
+        (*consumer)(selection.empty() ? i : selection[i], results[i]);
+}
+
+const Statistics& Framework::getStatistics(void) const{
+    return statisticData;
+}
+
+long long int Framework::getCacheHits(void) const{
+    return cache->getHits();
+}
+
+long long int Framework::getCacheMisses(void) const{
+    return cache->getMisses();
+}
@@ -0,0 +1,107 @@
+/**
+ * @file InputFile.cpp
+ */
+#include "InputFile.h"
+#include <string.h>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/** The whitespace characters (i.e. the separators between tokens), like isspace() in the "C" locale. */
+static const char WHITESPACE[] = " \t\n\v\f\r";
+
+InputFile::InputFile(void) {
+    buffer = 0;
+    size = 0;
+    cursor = 0;
+    mapped = false;
+}
+
+InputFile::~InputFile(void) {
+    close();
+}
+
+void InputFile::close(void){
+#ifndef _WIN32
+    if(mapped)
+        munmap(buffer, size);
+    else
+#endif
+    free(buffer);
+    buffer = 0;
+    size = 0;
+    cursor = 0;
+    mapped = false;
+}
+
+bool InputFile::open(const string& path){
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if(fd<0)
+        return false;
+    if(fstat(fd, &info)<0 || S_ISDIR(info.st_mode)){
+        ::close(fd);
+        return false;
+    }
+    size = info.st_size;
+
+    //the rest of the last page is filled with zeros, so the contents are followed by a terminating zero (unless the page is full)
+    if(size>0 && size%sysconf(_SC_PAGESIZE)!=0){ //a private (copy-on-write) mapping, so that the sequences can be compacted in place
+        void* memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if(memory!=MAP_FAILED){
+            madvise(memory, size, MADV_SEQUENTIAL);
+            buffer = (char*)memory;
+            mapped = true;
+            ::close(fd);
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+    //no memory mapping, so the whole file is read at once
+    ifstream input(path.c_str(), ios::binary | ios::ate);
+    if(!input.is_open())
+        return false;
+    size = input.tellg();
+    input.seekg(0);
+    buffer = (char*)malloc(size+1);
+    if(buffer==0 || !input.read(buffer, size)){
+        close();
+        return false;
+    }
+    buffer[size] = 0;
+    return true;
+}
+
+string_view InputFile::next_token(void){
+    const char* position = buffer + cursor;
+    const char* end = buffer + size;
+    const char* begin;
+
+    //the contents are terminated by a zero, so the (fast) functions of the C library can scan them
+    position += strspn(position, WHITESPACE);
+    begin = position;
+    position += strcspn(position, WHITESPACE);
+    while(position<end && *position==0) //a zero inside the contents is not whitespace
+        position += 1 + strcspn(position+1, WHITESPACE);
+    if(position>end)
+        position = end;
+
+    cursor = position - buffer;
+    return string_view(begin, position - begin);
+}
+
+string_view InputFile::concatenate(string_view sequence, string_view token){
+    if(sequence.empty())
+        return token;
+
+    char* end = buffer + (sequence.data() - buffer) + sequence.size();
+    memmove(end, token.data(), token.size());
+    return string_view(sequence.data(), sequence.size() + token.size());
+}
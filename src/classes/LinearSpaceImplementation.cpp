@@ -0,0 +1,280 @@
+/**
+ * @file LinearSpaceImplementation.cpp
+ */
+#include "LinearSpaceImplementation.h"
+#include <algorithm>
+
+LinearSpaceImplementation::LinearSpaceImplementation(int argc, char* argv[]):
+    Framework(argc, argv) {
+    statisticData.calcCellsTime = new long double[1];
+    statisticData.totalTracebackTime = new long double[1];
+    statisticData.calcCellsTime[0] = 0;
+    statisticData.totalTracebackTime[0] = 0;
+    peakMemory = 0;
+}
+
+LinearSpaceImplementation::~LinearSpaceImplementation() {
+    delete statisticData.calcCellsTime;
+    delete statisticData.totalTracebackTime;
+}
+
+int LinearSpaceImplementation::compute_cell(char q, char d, int diag, int left, int up, int& move){
+    int n1, n2, n3, value;
+
+    //compute the cell for match, mismatch and gap
+    if(q==d)
+        n1 = diag + algoScores.matchScore;
+    else
+        n1 = diag + algoScores.mismatchScore;
+    n2 = left + algoScores.gapScore;
+    n3 = up + algoScores.gapScore;
+    value = max(max(0, n1), max(n2, n3));
+
+    //the traceback prefers the diagonal, then the left and finally the up cell
+    if(value==n1)
+        move = DIAGONAL;
+    else if(value==n2)
+        move = LEFT;
+    else
+        move = UP;
+    return value;
+}
+
+long long int LinearSpaceImplementation::fill_scoring_rows(const Pair& sequences, vector<OptimalCell>& max_cells){
+    const size_t columns = sequences.d.size()+1;
+    vector<int> prev_row(columns, 0), row(columns, 0);
+    vector<Position> prev_origin(columns), origin(columns);  //the cell where the traceback of every cell stops
+    long long int cellsGreaterThanZero = 0;
+    int maxCell = 0, move, pred;
+    OptimalCell tmp_cell;
+
+    max_cells.clear();
+    peakMemory = max(peakMemory, 6*columns);
+
+    for(unsigned int r=1;r<=sequences.q.size();r++){ //for every row of scoring matrix
+        for(unsigned int c=1;c<columns;c++){ //for every column of scoring matrix
+            row[c] = compute_cell(sequences.q[r-1], sequences.d[c-1], prev_row[c-1], row[c-1], prev_row[c], move);
+            if(row[c]==0)
+                continue;
+            cellsGreaterThanZero++;
+
+            //follow the traceback for 1 step, and inherit the origin of the preceding cell
+            if(move==DIAGONAL){
+                pred = prev_row[c-1];
+                origin[c] = prev_origin[c-1];
+            }
+            else if(move==LEFT){
+                pred = row[c-1];
+                origin[c] = origin[c-1];
+            }
+            else{
+                pred = prev_row[c];
+                origin[c] = prev_origin[c];
+            }
+            if(pred==0){  //the traceback stops at this cell
+                origin[c].row = r;
+                origin[c].column = c;
+            }
+
+            //Search for the max value and save the Position x,y of max i matrix
+            if(row[c]>maxCell){
+                max_cells.clear();
+                maxCell = row[c];
+            }
+            if(row[c]==maxCell && (algoScores.maxAlignments==0 || max_cells.size()<algoScores.maxAlignments)){ //the first cells in row-major order are kept
+                tmp_cell.score = maxCell;
+                tmp_cell.end.row = r;
+                tmp_cell.end.column = c;
+                tmp_cell.origin = origin[c];
+                max_cells.push_back(tmp_cell);
+            }
+        }
+        swap(prev_row, row);
+        swap(prev_origin, origin);
+    }
+    return cellsGreaterThanZero;
+}
+
+void LinearSpaceImplementation::collect_boundaries(const Pair& sequences, vector<OptimalCell>& max_cells){
+    const size_t columns = sequences.d.size()+1;
+    vector<int> prev_row(columns, 0), row(columns, 0);
+    unsigned int last_row = 0;
+    size_t memory = 2*columns;
+    int move;
+
+    for(size_t k=0;k<max_cells.size();k++){
+        last_row = max(last_row, max_cells[k].end.row);
+        memory += (max_cells[k].end.column - max_cells[k].origin.column + 2) + (max_cells[k].end.row - max_cells[k].origin.row + 2);
+    }
+    peakMemory = max(peakMemory, memory);
+
+    for(unsigned int r=0;r<=last_row;r++){
+        if(r>0){
+            for(unsigned int c=1;c<columns;c++)
+                row[c] = compute_cell(sequences.q[r-1], sequences.d[c-1], prev_row[c-1], row[c-1], prev_row[c], move);
+        }
+        for(size_t k=0;k<max_cells.size();k++){
+            OptimalCell& cell = max_cells[k];
+            if(r==cell.origin.row-1)
+                cell.top.assign(row.begin()+cell.origin.column-1, row.begin()+cell.end.column+1);
+            if(r>=cell.origin.row-1 && r<=cell.end.row)
+                cell.left.push_back(row[cell.origin.column-1]);
+        }
+        swap(prev_row, row);
+    }
+}
+
+long long int LinearSpaceImplementation::align_rectangle(const Pair& sequences, unsigned int row0, unsigned int col0, unsigned int row1, unsigned int col1,
+                                                         const int* top, const int* left, Result& result){
+    long long int steps = 0;
+    int move, pred;
+
+    while(true){
+        const size_t rows = row1-row0+1;
+        const size_t columns = col1-col0+1;
+        if(rows<=2 || rows*columns<=BASE_CELLS)
+            return steps + traceback(sequences, row0, col0, row1, col1, top, left, result);
+
+        //1st pass: find the column where the traceback crosses the middle row, and keep that row
+        const unsigned int mid = row0 + (rows-1)/2;
+        vector<int> prev_row(top, top+columns+1), row(columns+1);
+        vector<int> prev_cross(columns+1, -1), cross(columns+1, -1);  //the column of the middle row where the traceback of a cell goes through
+        vector<int> mid_row;
+
+        for(unsigned int r=row0;r<=row1;r++){
+            row[0] = left[r-row0+1];
+            for(unsigned int c=col0;c<=col1;c++){
+                const size_t k = c-col0+1;
+                row[k] = compute_cell(sequences.q[r-1], sequences.d[c-1], prev_row[k-1], row[k-1], prev_row[k], move);
+                if(r==mid)
+                    cross[k] = c;
+                else if(r>mid){
+                    if(move==DIAGONAL){
+                        pred = prev_row[k-1];
+                        cross[k] = prev_cross[k-1];
+                    }
+                    else if(move==LEFT){
+                        pred = row[k-1];
+                        cross[k] = cross[k-1];
+                    }
+                    else{
+                        pred = prev_row[k];
+                        cross[k] = prev_cross[k];
+                    }
+                    if(row[k]==0 || pred==0) //the traceback stops before the middle row
+                        cross[k] = -1;
+                }
+            }
+            if(r==mid)
+                mid_row = row;
+            swap(prev_row, row);
+            swap(prev_cross, cross);
+        }
+        if(prev_cross[columns]<0)
+            throw logic_error("Error: The traceback does not reach the expected row.");
+        const unsigned int crossing = prev_cross[columns];
+
+        //2nd pass: keep the column before the crossing point, from the middle row and below
+        vector<int> cross_column(row1-mid+1);
+        cross_column[0] = mid_row[crossing-col0];
+        prev_row = mid_row;
+        for(unsigned int r=mid+1;r<=row1;r++){
+            row[0] = left[r-row0+1];
+            for(unsigned int c=col0;c<crossing;c++){
+                const size_t k = c-col0+1;
+                row[k] = compute_cell(sequences.q[r-1], sequences.d[c-1], prev_row[k-1], row[k-1], prev_row[k], move);
+            }
+            cross_column[r-mid] = row[crossing-col0];
+            swap(prev_row, row);
+        }
+        peakMemory = max(peakMemory, 7*(columns+1) + (row1-mid+1));
+
+        //the bottom part of the traceback (it is built in reverse order, so it comes first)
+        steps += align_rectangle(sequences, mid+1, crossing, row1, col1, &mid_row[crossing-col0], &cross_column[0], result);
+
+        //the top part of the traceback begins from the crossing point, and has the same boundaries
+        row1 = mid;
+        col1 = crossing;
+    }
+}
+
+long long int LinearSpaceImplementation::traceback(const Pair& sequences, unsigned int row0, unsigned int col0, unsigned int row1, unsigned int col1,
+                                                   const int* top, const int* left, Result& result){
+    const size_t rows = row1-row0+2, columns = col1-col0+2;
+    int move;
+
+    //fill the rectangle, surrounded by its boundaries
+    PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+    rectangle.reshape(rows, columns);
+    allocate.stop();
+    for(size_t c=0;c<columns;c++)
+        rectangle[0][c] = top[c];
+    for(size_t r=1;r<rows;r++){
+        rectangle[r][0] = left[r];
+        for(size_t c=1;c<columns;c++)
+            rectangle[r][c] = compute_cell(sequences.q[row0+r-2], sequences.d[col0+c-2], rectangle[r-1][c-1],
+                                                  rectangle[r][c-1], rectangle[r-1][c], move);
+    }
+
+    //trace back with the global coordinates of the cells, until the traceback leaves the rectangle from its top row
+    RectangleView view = {&rectangle, row0-1, col0-1};
+    return extendTraceback(sequences, view, row1, col1, row0, result);
+}
+
+void LinearSpaceImplementation::printStatistics(void){
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
+    cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
+    cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
+    cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
+    cout << "E) Total time of calculating cells: " << *statisticData.calcCellsTime << " seconds" << endl;
+    cout << "F) Total traceback time: " << *statisticData.totalTracebackTime << " seconds" << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellUpdates/(*statisticData.calcCellsTime) << endl;
+    cout << "I) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "J) Peak memory of the scoring rows: " << peakMemory*sizeof(int) << " bytes" << endl;
+    cout << "K) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
+}
+
+void LinearSpaceImplementation::alignPairs(void){
+    Result res;
+    long double time0 = getTime();
+	for(size_t i=0;i<data.size();i++){
+        vector<OptimalCell> max_cells;
+		results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+
+		long double time1 = getTime();
+        PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
+        statisticData.cellsGreaterThanZero += fill_scoring_rows(data[i], max_cells);
+        fill.stop();
+		*statisticData.calcCellsTime += getTime() - time1;
+        if(!keepPair(i, max_cells.empty() ? 0 : max_cells[0].score)) //before the second pass, which stores the boundaries
+            continue;
+
+        time1 = getTime();
+        PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+        collect_boundaries(data[i], max_cells);
+		for(size_t j=0;j<max_cells.size();j++){
+            const OptimalCell& cell = max_cells[j];
+            res.ref_id = i;
+			res.score = cell.score;
+			res.stop = cell.end.column-1;
+            res.result_pair.q.clear();
+            res.result_pair.d.clear();
+            res.result_pair.q.reserve(cell.end.row-cell.origin.row + cell.end.column-cell.origin.column + 2);
+            res.result_pair.d.reserve(res.result_pair.q.capacity());
+
+			statisticData.totalTracebackSteps += align_rectangle(data[i], cell.origin.row, cell.origin.column, cell.end.row, cell.end.column,
+                                                                 &cell.top[0], &cell.left[0], res);
+            reverse(res.result_pair.q.begin(), res.result_pair.q.end());
+            reverse(res.result_pair.d.begin(), res.result_pair.d.end());
+			results[i].push_back(res);
+		}
+        tracebacks.stop();
+		*statisticData.totalTracebackTime += getTime() - time1;
+        completeResults(i);
+	}
+	statisticData.totalTime += getTime() - time0;
+	statisticData.matrixAllocations += rectangle.getAllocations();
+}
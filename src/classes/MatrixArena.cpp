@@ -0,0 +1,35 @@
+/**
+ * @file MatrixArena.cpp
+ */
+#include "MatrixArena.h"
+#include <new>
+
+MatrixArena::MatrixArena(void) {
+    buffer = 0;
+    capacity = 0;
+    allocations = 0;
+}
+
+MatrixArena::~MatrixArena(void) {
+    if(buffer!=0)
+        operator delete(buffer, align_val_t(ALIGNMENT));
+}
+
+void* MatrixArena::reserve(size_t bytes){
+    if(bytes<=capacity)
+        return buffer;
+
+    bytes = (bytes + ALIGNMENT - 1)/ALIGNMENT*ALIGNMENT;  //whole cache lines
+    if(buffer!=0)
+        operator delete(buffer, align_val_t(ALIGNMENT));
+    buffer = 0;  //for the case that the allocation below fails
+    capacity = 0;
+    buffer = operator new(bytes, align_val_t(ALIGNMENT));  //the aligned operator new, so the allocations can be measured like any other
+    capacity = bytes;
+    allocations++;
+    return buffer;
+}
+
+long long int MatrixArena::getAllocations(void) const{
+    return allocations;
+}
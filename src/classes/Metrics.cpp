@@ -0,0 +1,239 @@
+/**
+ * @file Metrics.cpp
+ */
+#include "Metrics.h"
+#include <fstream>
+#include <iomanip>
+#include <string.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/** The names of the phases in the JSON file. */
+static const char* PHASE_NAMES[PHASES] = {"parse", "allocate", "fill", "max_scan", "traceback", "write"};
+
+/** The names of the hardware counters in the JSON file. */
+static const char* COUNTER_NAMES[COUNTERS] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+
+atomic<unsigned long long int> Metrics::instances(0);
+
+/**
+ * Opens a hardware counter of the calling thread (only its user-space events are counted, which needs no privileges).
+ * @param counter The {@link HardwareCounter}.
+ * @return The file descriptor of the counter, or -1 if it is not available.
+ */
+static int open_counter(HardwareCounter counter){
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;  //to scale the multiplexed counters
+    if(counter==CYCLES_COUNTER)
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    else if(counter==INSTRUCTIONS_COUNTER)
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    else if(counter==BRANCH_MISSES_COUNTER)
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    else{
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ<<8) | (PERF_COUNT_HW_CACHE_RESULT_MISS<<16);
+    }
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+/**
+ * Reads a hardware counter.
+ * @param fd The file descriptor of the counter.
+ * @param value Where the value of the counter is stored (scaled if the counter was multiplexed with others).
+ * @return True if the counter was read, otherwise false.
+ */
+static bool read_counter(int fd, long double& value){
+#ifdef __linux__
+    uint64_t data[3];  //the value, the time enabled and the time running
+    if(fd<0 || read(fd, data, sizeof(data))!=(ssize_t)sizeof(data) || data[2]==0)
+        return false;
+    value = (long double)data[0]*data[1]/data[2];
+    return true;
+#else
+    return false;
+#endif
+}
+
+Metrics::Metrics(bool tracing):
+    tracing(tracing) {
+    id = ++instances;
+    origin = now();
+}
+
+Metrics::~Metrics(void) {
+    for(size_t t=0;t<threads.size();t++){
+#ifdef __linux__
+        for(int c=0;c<COUNTERS;c++)
+            if(threads[t]->counters[c]>=0)
+                close(threads[t]->counters[c]);
+#endif
+        delete threads[t];
+    }
+}
+
+ThreadMetrics& Metrics::local(void){
+    thread_local unsigned long long int owner = 0;  //the object whose measurements the thread found last
+    thread_local ThreadMetrics* slot = 0;
+    if(owner==id)
+        return *slot;
+
+    slot = new ThreadMetrics();
+    for(int p=0;p<PHASES;p++){
+        slot->seconds[p] = 0;
+        slot->count[p] = 0;
+    }
+    slot->active = -1;
+    slot->since = 0;
+    slot->name = 0;
+    if(tracing)
+        slot->events.reserve(TRACE_RESERVE);
+    for(int c=0;c<COUNTERS;c++)
+        slot->counters[c] = open_counter((HardwareCounter)c);
+    {
+        lock_guard<mutex> guard(lock);
+        threads.push_back(slot);
+    }
+    owner = id;
+    return *slot;
+}
+
+void Metrics::setThreadName(const char* name){
+    local().name = name;
+}
+
+void Metrics::set(const string& name, long double value){
+    lock_guard<mutex> guard(lock);
+    summary.push_back(make_pair(name, value));
+}
+
+void Metrics::save(const string& path){
+    lock_guard<mutex> guard(lock);
+    ofstream output(path.c_str());
+    if(!output.is_open())
+        throw ios_base::failure((string("Metrics file ") + path + string(" cannot be opened.")).c_str());
+
+    long double totalSeconds[PHASES] = {0};
+    long long int totalCount[PHASES] = {0};
+    for(size_t t=0;t<threads.size();t++){
+        for(int p=0;p<PHASES;p++){
+            totalSeconds[p] += threads[t]->seconds[p];
+            totalCount[p] += threads[t]->count[p];
+        }
+    }
+
+    output << "{\n";
+    for(size_t s=0;s<summary.size();s++){
+        output << "  \"" << summary[s].first << "\": ";
+        if(summary[s].second==(long long int)summary[s].second) //the counts are written without an exponent
+            output << (long long int)summary[s].second << ",\n";
+        else
+            output << (double)summary[s].second << ",\n";
+    }
+    output << "  \"phases\": {";
+    for(int p=0;p<PHASES;p++)
+        output << (p>0 ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": {\"seconds\": " << (double)totalSeconds[p] << ", \"count\": " << totalCount[p] << "}";
+    output << "},\n  \"threads\": [";
+    for(size_t t=0;t<threads.size();t++){
+        output << (t>0 ? "," : "") << "\n    {\"thread\": " << t << ", \"name\": \"" << (threads[t]->name ? threads[t]->name : "worker")
+               << "\", \"phases\": {";
+        for(int p=0;p<PHASES;p++)
+            output << (p>0 ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": {\"seconds\": " << (double)threads[t]->seconds[p] << ", \"count\": " << threads[t]->count[p] << "}";
+        output << "}, \"counters\": {";
+        for(int c=0;c<COUNTERS;c++){
+            long double value;
+            output << (c>0 ? ", " : "") << "\"" << COUNTER_NAMES[c] << "\": ";
+            if(read_counter(threads[t]->counters[c], value))
+                output << (unsigned long long int)value;
+            else
+                output << "null";  //not supported by the processor, or not permitted (see /proc/sys/kernel/perf_event_paranoid)
+        }
+        output << "}}";
+    }
+    output << "\n  ]\n}\n";
+
+    output.close();
+    if(output.fail())
+        throw ios_base::failure((string("Metrics file ") + path + string(" cannot be written.")).c_str());
+}
+
+void Metrics::saveTrace(const string& path){
+    lock_guard<mutex> guard(lock);
+    ofstream output(path.c_str());
+    if(!output.is_open())
+        throw ios_base::failure((string("Trace file ") + path + string(" cannot be opened.")).c_str());
+
+    //the timestamps are in microseconds since the construction of this object; every thread is a row of the timeline
+    output << fixed << setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for(size_t t=0;t<threads.size();t++){
+        output << (t>0 ? "," : "") << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << t
+               << ", \"args\": {\"name\": \"" << (threads[t]->name ? threads[t]->name : "worker") << " " << t << "\"}}";
+        for(size_t e=0;e<threads[t]->events.size();e++){
+            const TraceEvent& event = threads[t]->events[e];
+            output << ",\n{\"name\": \"" << PHASE_NAMES[event.phase] << "\", \"cat\": \"phase\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << t
+                   << ", \"ts\": " << (double)((event.begin - origin)*1e6) << ", \"dur\": " << (double)((event.end - event.begin)*1e6)
+                   << ", \"args\": {";
+            const char* separator = "";
+            if(event.pair>=0){
+                output << "\"pair\": " << event.pair;
+                separator = ", ";
+            }
+            if(event.diagonal>=0)
+                output << separator << "\"diagonal\": " << event.diagonal << ", \"tile\": " << event.tile;
+            output << "}}";
+        }
+    }
+    output << "\n]}\n";
+
+    output.close();
+    if(output.fail())
+        throw ios_base::failure((string("Trace file ") + path + string(" cannot be written.")).c_str());
+}
+
+PhaseTimer::PhaseTimer(Metrics* metrics, Phase phase, long long int pair, long long int diagonal, long long int tile):
+    slot(0), phase(phase), parent(-1), traced(false) {
+    if(metrics==0)
+        return;
+    slot = &metrics->local();
+    long double now = Metrics::now();
+    parent = slot->active;
+    if(parent>=0) //the outer phase is paused
+        slot->seconds[parent] += now - slot->since;
+    slot->active = phase;
+    slot->since = now;
+
+    traced = metrics->isTracing();
+    event.phase = phase;
+    event.begin = now;
+    event.pair = pair;
+    event.diagonal = diagonal;
+    event.tile = tile;
+}
+
+void PhaseTimer::stop(void){
+    if(slot==0)
+        return;
+    long double now = Metrics::now();
+    slot->seconds[phase] += now - slot->since;
+    slot->count[phase]++;
+    slot->active = parent;
+    slot->since = now;
+    if(traced){ //only this thread appends to its events, so no locking is needed
+        event.end = now;
+        slot->events.push_back(event);
+    }
+    slot = 0;
+}
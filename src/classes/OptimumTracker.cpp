@@ -0,0 +1,60 @@
+/**
+ * @file OptimumTracker.cpp
+ */
+#include "OptimumTracker.h"
+
+/**
+ * Compares two cells in row-major order.
+ * @param a The first cell.
+ * @param b The second cell.
+ * @return True if the first cell precedes the second one, otherwise false.
+ */
+static bool precedes(const Position& a, const Position& b){
+    return a.row<b.row || (a.row==b.row && a.column<b.column);
+}
+
+OptimumTracker::OptimumTracker(unsigned int limit) {
+    this->limit = limit;
+    best = 0;
+}
+
+void OptimumTracker::reset(void){
+    best = 0;
+    positions.clear();
+}
+
+void OptimumTracker::add(unsigned int row, unsigned int column){
+    Position cell;
+    cell.row = row;
+    cell.column = column;
+    if(limit==0){
+        positions.push_back(cell);
+        return;
+    }
+    if(positions.size()<limit){
+        positions.push_back(cell);
+        push_heap(positions.begin(), positions.end(), precedes);
+    }
+    else if(precedes(cell, positions.front())){ //it replaces the last of the kept cells (never when the cells arrive in row-major order)
+        pop_heap(positions.begin(), positions.end(), precedes);
+        positions.back() = cell;
+        push_heap(positions.begin(), positions.end(), precedes);
+    }
+}
+
+void OptimumTracker::merge(const OptimumTracker& other){
+    if(other.best<best || other.best<=0)
+        return;
+    if(other.best>best){
+        best = other.best;
+        positions.clear();
+    }
+    for(size_t i=0;i<other.positions.size();i++)
+        add(other.positions[i].row, other.positions[i].column);
+}
+
+void OptimumTracker::collect(vector<Position>& max_pos) const{
+    max_pos = positions;
+    if(!is_sorted(max_pos.begin(), max_pos.end(), precedes))
+        sort(max_pos.begin(), max_pos.end(), precedes);
+}
\ No newline at end of file
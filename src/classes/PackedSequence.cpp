@@ -0,0 +1,113 @@
+/**
+ * @file PackedSequence.cpp
+ */
+#include "PackedSequence.h"
+#include <algorithm>
+
+PackedSequence::PackedSequence(void) {
+    words = 0;
+    start = 0;
+    length = 0;
+    bits = 8;
+    mask = 0xFF;
+    alphabet = 0;
+}
+
+PackedSequence::PackedSequence(const uint64_t* words, size_t start, size_t length, const Alphabet* alphabet):
+    words(words), start(start), length(length), alphabet(alphabet) {
+    bits = alphabet->bits;
+    mask = (1u<<bits) - 1;
+}
+
+string PackedSequence::str(void) const{
+    string symbols(length, 0);
+    for(size_t i=0;i<length;i++)
+        symbols[i] = symbol(i);
+    return symbols;
+}
+
+bool PackedSequence::operator==(const PackedSequence& other) const{
+    if(length!=other.length)
+        return false;
+    if(alphabet==other.alphabet){ //the same store, so the codes are compared without being decoded
+        for(size_t i=0;i<length;i++)
+            if((*this)[i]!=other[i])
+                return false;
+        return true;
+    }
+    for(size_t i=0;i<length;i++)
+        if(symbol(i)!=other.symbol(i))
+            return false;
+    return true;
+}
+
+bool PackedSequence::operator==(string_view other) const{
+    if(length!=other.size())
+        return false;
+    for(size_t i=0;i<length;i++)
+        if(symbol(i)!=other[i])
+            return false;
+    return true;
+}
+
+bool PackedSequence::operator<(const PackedSequence& other) const{
+    size_t common = min(length, other.length);
+    for(size_t i=0;i<common;i++){
+        unsigned char a = symbol(i), b = other.symbol(i);  //like std::string, the symbols are compared as unsigned characters
+        if(a!=b)
+            return a<b;
+    }
+    return length<other.length;
+}
+
+ostream& operator<<(ostream& output, const PackedSequence& sequence){
+    return output << sequence.str();
+}
+
+SequenceStore::SequenceStore(void) {
+    alphabet.bits = 1;
+    alphabet.size = 0;
+}
+
+void SequenceStore::pack(const vector<string_view>& sequences, vector<PackedSequence>& packed){
+    bool present[256] = {false};
+    unsigned char codes[256];
+    size_t total = 0, position = 0;
+
+    //detect the alphabet, whose symbols take the codes in ascending order
+    for(size_t k=0;k<sequences.size();k++){
+        for(size_t i=0;i<sequences[k].size();i++)
+            present[(unsigned char)sequences[k][i]] = true;
+        total += sequences[k].size();
+    }
+    alphabet.size = 0;
+    for(int c=0;c<256;c++){
+        if(present[c]){
+            codes[c] = alphabet.size;
+            alphabet.symbols[alphabet.size++] = c;
+        }
+    }
+    alphabet.bits = 1;
+    while((1u<<alphabet.bits)<alphabet.size)
+        alphabet.bits *= 2;
+
+    vector<uint64_t>((total*alphabet.bits + 63)/64, 0).swap(words);  //the memory of any previous sequences is released
+    packed.clear();
+    packed.reserve(sequences.size());
+    for(size_t k=0;k<sequences.size();k++){
+        size_t start = position;
+        for(size_t i=0;i<sequences[k].size();i++,position++){
+            size_t bit = position*alphabet.bits;
+            words[bit>>6] |= (uint64_t)codes[(unsigned char)sequences[k][i]]<<(bit&63);
+        }
+        packed.push_back(PackedSequence(words.data(), start, sequences[k].size(), &alphabet));
+    }
+}
+
+const Alphabet& SequenceStore::getAlphabet(void) const{
+    return alphabet;
+}
+
+size_t SequenceStore::getBytes(void) const{
+    return words.size()*sizeof(uint64_t);
+}
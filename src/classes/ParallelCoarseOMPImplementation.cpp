@@ -2,6 +2,8 @@
  * @file ParallelCoarseOMPImplementation.cpp
  */
 #include "ParallelCoarseOMPImplementation.h"
+#include "OptimumTracker.h"
+#include <algorithm>
 
 ParallelCoarseOMPImplementation::ParallelCoarseOMPImplementation(int argc, char* argv[]): Framework(argc, argv) {
     int i;
@@ -20,6 +22,15 @@ ParallelCoarseOMPImplementation::ParallelCoarseOMPImplementation(int argc, char*
          if(i==argc-1)
             throw invalid_argument("Error. Missing arguments.");
     }
+    if((int)threads<=0)
+        throw invalid_argument("Error. The number of threads must be a positive integer.");
+
+    queues.resize(threads);
+    locks.resize(threads);
+    for(size_t i=0;i<threads;i++)
+        omp_init_lock(&locks[i]);
+    busyTime.assign(threads, 0);
+    stolenPairs = 0;
 
     statisticData.calcCellsTime = new long double[threads];
     statisticData.totalTracebackTime = new long double[threads];
@@ -30,21 +41,20 @@ ParallelCoarseOMPImplementation::ParallelCoarseOMPImplementation(int argc, char*
 }
 
 ParallelCoarseOMPImplementation::~ParallelCoarseOMPImplementation() {
+    for(size_t i=0;i<threads;i++)
+        omp_destroy_lock(&locks[i]);
     delete statisticData.calcCellsTime;
     delete statisticData.totalTracebackTime;
 }
 
-long long int ParallelCoarseOMPImplementation::fill_scoring_matrix(Pair sequences, vector< vector<int> >& scoring_matrix, vector<Position>& max_pos){
+long long int ParallelCoarseOMPImplementation::fill_scoring_matrix(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos){
 	int n1, n2, n3;
-	int maxCell=0;
+	OptimumTracker tracker(algoScores.maxAlignments);
 	unsigned int row, col;
-	Position tmp_pos;
 	long long int cellsGreaterThanZero=0;
 
-	max_pos.clear();
-
 	for(row=0;row<scoring_matrix.size();row++){
-		for(col=0;col<scoring_matrix[row].size();col++){
+		for(col=0;col<scoring_matrix.columns();col++){
 			if((row==0) || (col==0)){
 				scoring_matrix[row][col] = 0;
 			}
@@ -76,134 +86,135 @@ long long int ParallelCoarseOMPImplementation::fill_scoring_matrix(Pair sequence
 			}
 
 			if(scoring_matrix[row][col]>0)
-				statisticData.cellsGreaterThanZero++;
-
-			if(scoring_matrix[row][col]>maxCell){
-				max_pos.clear();
-				tmp_pos.row=row;
-				tmp_pos.column=col;
-				max_pos.push_back(tmp_pos);
-				maxCell = scoring_matrix[row][col];
-			}
-			else if(scoring_matrix[row][col]==maxCell){
-				tmp_pos.row=row;
-				tmp_pos.column=col;
-				max_pos.push_back(tmp_pos);
-			}
+				cellsGreaterThanZero++;
+
+			tracker.update(scoring_matrix[row][col], row, col);
 		}
 	}
+	tracker.collect(max_pos);
 	return cellsGreaterThanZero;
 }
 
+void ParallelCoarseOMPImplementation::schedule_pairs(void){
+    vector<size_t> order(data.size());
+    for(size_t i=0;i<data.size();i++)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b){
+        return (long long int)data[a].q.size()*data[a].d.size() > (long long int)data[b].q.size()*data[b].d.size();
+    });
+
+    //round robin, so every thread begins with one of the most expensive pairs
+    for(size_t i=0;i<threads;i++)
+        queues[i].clear();
+    for(size_t i=0;i<order.size();i++)
+        queues[i%threads].push_back(order[i]);
+}
+
+bool ParallelCoarseOMPImplementation::next_pair(unsigned int thread, size_t& pair, long long int& stolen){
+    bool found = false;
+
+    omp_set_lock(&locks[thread]);
+    if(!queues[thread].empty()){
+        pair = queues[thread].front();
+        queues[thread].pop_front();
+        found = true;
+    }
+    omp_unset_lock(&locks[thread]);
+
+    //the pairs are never added to the queues during the execution, so if all of them are empty the work is done;
+    //the most expensive pair of the victim is stolen, since the cheaper ones are easier to balance at the end
+    for(unsigned int i=1;i<threads && !found;i++){
+        unsigned int victim = (thread+i)%threads;
+        omp_set_lock(&locks[victim]);
+        if(!queues[victim].empty()){
+            pair = queues[victim].front();
+            queues[victim].pop_front();
+            found = true;
+            stolen++;
+        }
+        omp_unset_lock(&locks[victim]);
+    }
+    return found;
+}
+
 void ParallelCoarseOMPImplementation::printStatistics(void){
-    cout << "A) Total pairs of sequences Q-D: " << data.size() << endl;
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
     cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
     cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
     cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
-    cout << "E) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellsGreaterThanZero/statisticData.totalTime << endl;
+    cout << "E) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
     for(size_t i=0;i<threads;i++){
         cout << "F) Thread " << i << " - Total time of calculating cells: " << statisticData.calcCellsTime[i] << " seconds" << endl;
         cout << "G) Thread " << i << " - Total traceback time: " << statisticData.totalTracebackTime[i] << " seconds" << endl;
-        cout << "H) Thread " << i << " - Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellsGreaterThanZero/statisticData.calcCellsTime[i] << endl;
+        cout << "H) Thread " << i << " - Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellUpdates/statisticData.calcCellsTime[i] << endl;
     }
+    cout << "I) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+
+    long double maxBusy = 0, sumBusy = 0;
+    for(size_t i=0;i<threads;i++){
+        maxBusy = max(maxBusy, busyTime[i]);
+        sumBusy += busyTime[i];
+    }
+    cout << "J) Load imbalance (maximum/average busy time of the threads): " << (sumBusy>0 ? maxBusy*threads/sumBusy : 1) << endl;
+    cout << "K) Pairs stolen from other threads: " << stolenPairs << endl;
+    cout << "L) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
 }
 
-void ParallelCoarseOMPImplementation::runAlgorithm(void){
+void ParallelCoarseOMPImplementation::alignPairs(void){
     long double time0 = getTime();
 
+    schedule_pairs();
     #pragma omp parallel shared(data, algoScores, results, statisticData) num_threads(threads)
     {
         Result res;
+        ScoringMatrix scoring_matrix;  //every thread reuses its own matrix for all of its pairs
         vector<Position> max_pos_vec;
-        vector<Result> results_vec;
-        int cells=0, steps=0;
+        long long int cells=0, steps=0, stolen=0;
         double tr_time=0, f_time=0;
+        size_t i;
 
-        #pragma omp for
-        for(size_t i=0;i<data.size();i++){
-            vector< vector<int> > scoring_matrix(data[i].q.size()+1, vector<int>(data[i].d.size()+1));
+        while(next_pair(omp_get_thread_num(), i, stolen)){
+            results[i].clear(); //for the case that this method is accidentally executed more than once
+            if(reuseResults(i)) //an identical pair has already been aligned
+                continue;
+            PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+            scoring_matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+            allocate.stop();
 
             double time_f1 = getTime();
+            PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
             cells += fill_scoring_matrix(data[i], scoring_matrix, max_pos_vec);
+            fill.stop();
             double time_f2 = getTime();
             f_time += (time_f2-time_f1);
+            if(!keepPair(i, max_pos_vec.empty() ? 0 : scoring_matrix[max_pos_vec[0].row][max_pos_vec[0].column]))
+                continue;
 
+            double time_tr1 = getTime();  //the clock is read once for all the tracebacks of the pair, since they are usually short
+            PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
             for(size_t j=0;j<max_pos_vec.size();j++){
                 res.score = scoring_matrix[max_pos_vec[j].row][max_pos_vec[j].column];
                 res.stop = max_pos_vec[j].column-1;
                 res.ref_id = i;
-                results_vec.push_back(res);
-
-                double time_tr1 = getTime();
-                steps += traceback(1, max_pos_vec[j].row, max_pos_vec[j].column, data[i], scoring_matrix, results_vec);
-                double time_tr2 = getTime();
-                tr_time += (time_tr2-time_tr1);
-            }
-        }
-        for(size_t i=0;i<results_vec.size();i++){
-            #pragma omp critical
-            {
-                results[results_vec[i].ref_id].push_back(results_vec[i]);
+                results[i].push_back(res);  //every pair is aligned by a single thread, so no locking is needed
+                steps += traceback(data[i], scoring_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
             }
+            tracebacks.stop();
+            double time_tr2 = getTime();
+            tr_time += (time_tr2-time_tr1);
+            completeResults(i);
         }
 
         #pragma omp critical
         {
-            statisticData.calcCellsTime[omp_get_thread_num()] = f_time;
-            statisticData.totalTracebackTime[omp_get_thread_num()] = tr_time;
+            statisticData.calcCellsTime[omp_get_thread_num()] += f_time;
+            statisticData.totalTracebackTime[omp_get_thread_num()] += tr_time;
             statisticData.cellsGreaterThanZero += cells;
             statisticData.totalTracebackSteps += steps;
+            statisticData.matrixAllocations += scoring_matrix.getAllocations();
+            busyTime[omp_get_thread_num()] += f_time + tr_time;
+            stolenPairs += stolen;
         }
     }
-  	statisticData.totalTime = getTime() - time0;
-}
-
-long long int ParallelCoarseOMPImplementation::traceback(int steps, int start_row, int start_col, Pair sequences, vector< vector<int> >& scoring_matrix, vector<Result>& results_vec){
-	unsigned int index = results_vec.size()-1;
-	int n1, n2, n3;
-
-
-	if(sequences.q[start_row-1]==sequences.d[start_col-1])			 //diagonally up left
-		n1 = scoring_matrix[start_row-1][start_col-1] + algoScores.matchScore;
-	else
-		n1 = scoring_matrix[start_row-1][start_col-1] + algoScores.mismatchScore;
-
-	n2 = scoring_matrix[start_row][start_col-1] + algoScores.gapScore;  //left
-	n3 = scoring_matrix[start_row-1][start_col] + algoScores.gapScore;  //up
-
-
-	if(scoring_matrix[start_row][start_col]==n1){  //diagonally
-		results_vec[index].result_pair.q = sequences.q[start_row-1] + results_vec[index].result_pair.q;
-		results_vec[index].result_pair.d = sequences.d[start_col-1] + results_vec[index].result_pair.d;
-
-		if(scoring_matrix[start_row-1][start_col-1]==0){
-			results_vec[index].start = start_col-1;
-			return steps;
-		}
-		else
-			return traceback(steps+1, start_row-1, start_col-1, sequences, scoring_matrix, results_vec);
-	}
-	else if(scoring_matrix[start_row][start_col]==n2){ //left
-		results_vec[index].result_pair.q = "-" + results_vec[index].result_pair.q;
-		results_vec[index].result_pair.d = sequences.d[start_col-1] + results_vec[index].result_pair.d;
-
-		if(scoring_matrix[start_row][start_col-1]==0){
-			results_vec[index].start = start_col-1;
-			return steps;
-		}
-		else
-			return traceback(steps+1, start_row, start_col-1, sequences, scoring_matrix, results_vec);
-	}
-	else if(scoring_matrix[start_row][start_col]==n3){ //up
-		results_vec[index].result_pair.q = sequences.q[start_row-1] + results_vec[index].result_pair.q;
-		results_vec[index].result_pair.d = "-" + results_vec[index].result_pair.d;
-
-		if(scoring_matrix[start_row-1][start_col]==0){
-			results_vec[index].start = start_col-1;
-			return steps;
-		}
-		else
-			return traceback(steps+1, start_row-1, start_col, sequences, scoring_matrix, results_vec);
-	}
-	return 0;
+  	statisticData.totalTime += getTime() - time0;
 }
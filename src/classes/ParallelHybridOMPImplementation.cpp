@@ -0,0 +1,128 @@
+/**
+ * @file ParallelHybridOMPImplementation.cpp
+ */
+#include "ParallelHybridOMPImplementation.h"
+
+ParallelHybridOMPImplementation::ParallelHybridOMPImplementation(int argc, char* argv[]): WavefrontImplementation(argc, argv) {
+    threshold = 0;
+    for(int i=0;i<argc-1;i+=1){ //the threshold is optional
+        if(!string(argv[i]).compare("-threshold")){
+            if(atoll(argv[i+1])<=0)
+                throw invalid_argument("Error. The threshold must be a positive integer.");
+            threshold = atoll(argv[i+1]);
+        }
+    }
+
+    usedThreshold = 0;
+    wavefrontPairs = 0;
+    singlePairs = 0;
+    wavefrontTime = 0;
+    singleTime = 0;
+}
+
+ParallelHybridOMPImplementation::~ParallelHybridOMPImplementation(){
+}
+
+void ParallelHybridOMPImplementation::printStatistics(void){
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
+    cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
+    cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
+    cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
+    cout << "E) Total time of calculating cells (summed over the threads of the pairs aligned by single threads): " << *statisticData.calcCellsTime << " seconds" << endl;
+    cout << "F) Total traceback time (summed over the threads of the pairs aligned by single threads): " << *statisticData.totalTracebackTime << " seconds" << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cost threshold of the wavefront: " << usedThreshold << " cells" << (threshold>0 ? "" : " (tuned automatically)") << endl;
+    cout << "I) Pairs aligned as a wavefront by all the threads: " << wavefrontPairs << " in " << wavefrontTime << " seconds" << endl;
+    cout << "J) Pairs aligned by single threads: " << singlePairs << " in " << singleTime << " seconds" << endl;
+    cout << "K) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "L) Tile size of the wavefront: " << tile << "x" << tile << " cells" << endl;
+    cout << "M) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
+}
+
+void ParallelHybridOMPImplementation::alignPairs(void){
+    long double time0 = getTime();
+
+    //the pairs from the most expensive to the cheapest, so that the single threads begin with the pairs that are hardest to balance
+    vector<size_t> order(data.size());
+    for(size_t i=0;i<data.size();i++)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b){
+        return (long long int)data[a].q.size()*data[a].d.size() > (long long int)data[b].q.size()*data[b].d.size();
+    });
+    usedThreshold = threshold>0 ? threshold : tune_threshold();
+    size_t split = 0;  //the pairs before it are aligned as a wavefront
+    while(split<order.size() && (long long int)(data[order[split]].q.size()*data[order[split]].d.size())>=usedThreshold)
+        split++;
+
+    ScoringMatrix scoring_matrix;  //reused for every pair of the wavefront
+    for(size_t k=0;k<split;k++){
+        size_t i = order[k];
+        vector<Position> max_pos_vec;
+        results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+        PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+        scoring_matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+        allocate.stop();
+
+        statisticData.cellsGreaterThanZero += fill_wavefront(data[i], firstPair + i, scoring_matrix, max_pos_vec);
+        if(!keepPair(i, max_pos_vec.empty() ? 0 : scoring_matrix[max_pos_vec[0].row][max_pos_vec[0].column]))
+            continue;
+
+        PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+        statisticData.totalTracebackSteps += trace_pair(i, scoring_matrix, max_pos_vec);
+        tracebacks.stop();
+        completeResults(i);
+        wavefrontPairs++;
+    }
+    statisticData.matrixAllocations += scoring_matrix.getAllocations();
+    long double time1 = getTime();
+    wavefrontTime += time1 - time0;
+
+    #pragma omp parallel num_threads(threads)
+    {
+        ScoringMatrix matrix;  //every thread reuses its own matrix for all of its pairs
+        vector<Position> max_pos_vec;
+        long long int cells=0, steps=0, pairs=0;
+        double tr_time=0, f_time=0;
+
+        #pragma omp for schedule(dynamic, 1)
+        for(long long int k=split;k<(long long int)order.size();k++){
+            size_t i = order[k];
+            results[i].clear(); //for the case that this method is accidentally executed more than once
+            if(reuseResults(i)) //an identical pair has already been aligned
+                continue;
+            PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+            matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+            allocate.stop();
+
+            double time_f1 = getTime();
+            PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
+            cells += fill_sequential(data[i], matrix, max_pos_vec);
+            fill.stop();
+            double time_f2 = getTime();  //the clock is read once more for all the tracebacks of the pair, since they are usually short
+            f_time += time_f2 - time_f1;
+            if(!keepPair(i, max_pos_vec.empty() ? 0 : matrix[max_pos_vec[0].row][max_pos_vec[0].column]))
+                continue;
+
+            PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+            steps += trace_pair(i, matrix, max_pos_vec);
+            tracebacks.stop();
+            tr_time += getTime() - time_f2;
+            completeResults(i);
+            pairs++;
+        }
+
+        #pragma omp critical
+        {
+            *statisticData.calcCellsTime += f_time;
+            *statisticData.totalTracebackTime += tr_time;
+            statisticData.cellsGreaterThanZero += cells;
+            statisticData.totalTracebackSteps += steps;
+            statisticData.matrixAllocations += matrix.getAllocations();
+            singlePairs += pairs;
+        }
+    }
+    singleTime += getTime() - time1;
+    statisticData.totalTime += getTime() - time0;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file ReportWriter.cpp
+ */
+#include "ReportWriter.h"
+
+ReportWriter::ReportWriter(const string& path, Metrics* metrics):
+    metrics(metrics), path(path), buffer(BUFFER_SIZE) {
+    next = 0;
+    closing = false;
+
+    output.rdbuf()->pubsetbuf(&buffer[0], buffer.size());  //must precede open() to take effect
+    output.open(path.c_str());
+    if(!output.is_open())
+        throw ios_base::failure((string("Output file ") + path + string(" cannot be opened.")).c_str());
+    worker = thread(&ReportWriter::run, this);
+}
+
+ReportWriter::~ReportWriter(void) {
+    try{
+        close();
+    }catch(...){
+        //errors can only be reported by an explicit call of close()
+    }
+}
+
+void ReportWriter::write(size_t index, const Pair& sequences, vector<Result>&& results){
+    unique_lock<mutex> guard(lock);
+
+    //the pair that the writer waits for is never held back, since the pending pairs cannot be written before it
+    written.wait(guard, [this, index]{ return pending.size()<MAX_PENDING || index==next; });
+    pending[index] = PendingPair{sequences, move(results), false};
+    if(index==next)
+        handedOver.notify_one();
+}
+
+void ReportWriter::skip(size_t index){
+    lock_guard<mutex> guard(lock);
+    pending[index] = PendingPair{Pair(), vector<Result>(), true};  //it holds no memory, so there is no need to wait
+    if(index==next)
+        handedOver.notify_one();
+}
+
+void ReportWriter::wait(size_t count){
+    unique_lock<mutex> guard(lock);
+    written.wait(guard, [this, count]{ return next>=count; });
+}
+
+void ReportWriter::close(void){
+    {
+        lock_guard<mutex> guard(lock);
+        if(closing)
+            return;
+        closing = true;
+    }
+    handedOver.notify_one();
+    worker.join();
+
+    output.close();
+    if(output.fail())
+        throw ios_base::failure((string("Output file ") + path + string(" cannot be written.")).c_str());
+}
+
+void ReportWriter::run(void){
+    if(metrics)
+        metrics->setThreadName("writer");
+    unique_lock<mutex> guard(lock);
+
+    while(true){
+        handedOver.wait(guard, [this]{ return closing || (!pending.empty() && pending.begin()->first==next); });
+        if(pending.empty())  //closing, and everything has been written
+            break;
+        if(pending.begin()->first!=next)  //closing, but some pairs were never handed over, so the rest are written in order
+            next = pending.begin()->first;
+
+        PendingPair entry = move(pending.begin()->second);
+        pending.erase(pending.begin());
+
+        if(!entry.skipped){
+            guard.unlock();  //the other threads may hand over pairs while this one is written
+            {
+                PhaseTimer timer(metrics, WRITE_PHASE);
+                write_pair(output, entry.sequences, entry.results);
+            }
+            guard.lock();
+        }
+        next++;  //only now, since wait() lets the memory of the sequences be released
+        written.notify_all();
+    }
+}
+
+void ReportWriter::write_pair(ostream& output, const Pair& sequences, const vector<Result>& results){
+    output << "Q: " << sequences.q << '\n';
+    output << "D: " << sequences.d << '\n';
+
+    for(size_t j=0;j<results.size();j++){
+        output << "Match " << j+1 << " [Score: " << results[j].score << ", Start: " << results[j].start << ", Stop: " << results[j].stop << "]" << '\n';
+        output << "	D: " << results[j].result_pair.d << '\n';
+        output << "	Q: " << results[j].result_pair.q << '\n';
+    }
+}
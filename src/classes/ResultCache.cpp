@@ -0,0 +1,229 @@
+/**
+ * @file ResultCache.cpp
+ */
+#include "ResultCache.h"
+
+/** The first bytes of a file with the entries of a {@link ResultCache}. */
+static const char CACHE_MAGIC[8] = {'S', 'W', 'C', 'A', 'C', 'H', 'E', '2'};
+
+/**
+ * Adds a value to a {@link CacheKey}. The two halves are computed with different functions
+ * (FNV-1a and a multiplicative hash), so that they are independent of each other.
+ * @param key The key.
+ * @param value The value to add.
+ */
+static void mix(CacheKey& key, uint64_t value){
+    key.high = (key.high ^ value)*0x100000001B3ULL;
+    key.low = (key.low + value + 1)*0x9E3779B97F4A7C15ULL;
+    key.low ^= key.low>>29;
+}
+
+/**
+ * Constructs the key of an entry from the symbols of its sequences, the scores and the variant of the alignments. The sizes
+ * of the sequences are added too, so that the boundary between them is part of the key. The sequences themselves are not
+ * stored, so two different pairs with the same key would share their alignments: the hash is not cryptographic, but with
+ * 128 bits the probability of a collision among n entries is about n*n/2^129 (below 10^-27 for a billion entries).
+ * @param sequences A {@link Pair} object with the sequences.
+ * @param scores The {@link Scores} of the algorithm.
+ * @param variant The variant of the alignments (empty for the exact ones).
+ * @return The {@link CacheKey} of the entry.
+ */
+static CacheKey hash_entry(const Pair& sequences, const Scores& scores, const string& variant){
+    CacheKey key = {0xCBF29CE484222325ULL, 0};
+    mix(key, sequences.q.size());
+    for(size_t i=0;i<sequences.q.size();i++)
+        mix(key, (unsigned char)sequences.q.symbol(i));
+    mix(key, sequences.d.size());
+    for(size_t i=0;i<sequences.d.size();i++)
+        mix(key, (unsigned char)sequences.d.symbol(i));
+    mix(key, (uint64_t)(int64_t)scores.matchScore);
+    mix(key, (uint64_t)(int64_t)scores.mismatchScore);
+    mix(key, (uint64_t)(int64_t)scores.gapScore);
+    mix(key, scores.maxAlignments);
+    mix(key, scores.collapseAlignments);
+    if(!variant.empty()){
+        mix(key, variant.size());
+        for(size_t i=0;i<variant.size();i++)
+            mix(key, (unsigned char)variant[i]);
+    }
+    return key;
+}
+
+/**
+ * Writes an integer into a binary file.
+ * @param output The file.
+ * @param value The integer to write.
+ */
+static void write_int(ofstream& output, long long int value){
+    output.write((const char*)&value, sizeof(value));
+}
+
+/**
+ * Writes a string (its size followed by its characters) into a binary file.
+ * @param output The file.
+ * @param value The string to write.
+ */
+static void write_string(ofstream& output, const string& value){
+    write_int(output, value.size());
+    output.write(value.data(), value.size());
+}
+
+/**
+ * Reads an integer that was written by write_int().
+ * @param input The file.
+ * @return A long long integer with the value that was read.
+ * @throws std::runtime_error Thrown if the end of the file was reached.
+ */
+static long long int read_int(ifstream& input){
+    long long int value;
+    if(!input.read((char*)&value, sizeof(value)))
+        throw runtime_error("Error: Invalid contents of the cache file...");
+    return value;
+}
+
+/**
+ * Reads a string that was written by write_string().
+ * @param input The file.
+ * @return The string that was read.
+ * @throws std::runtime_error Thrown if the end of the file was reached.
+ */
+static string read_string(ifstream& input){
+    long long int size = read_int(input);
+    if(size<0)
+        throw runtime_error("Error: Invalid contents of the cache file...");
+    string value(size, '\0');
+    if(!input.read(&value[0], size))
+        throw runtime_error("Error: Invalid contents of the cache file...");
+    return value;
+}
+
+ResultCache::ResultCache(size_t capacity) {
+    this->capacity = capacity;
+    shardCount = capacity==0 ? 1 : (capacity<SHARDS ? capacity : SHARDS);  //a small cache has fewer shards, so that every shard has room
+    for(size_t s=0;s<SHARDS;s++) //the entries are split evenly, so that there are never more than the capacity
+        shards[s].capacity = s<shardCount ? capacity/shardCount + (s<capacity%shardCount ? 1 : 0) : 0;
+    hits = 0;
+    misses = 0;
+}
+
+CacheKey ResultCache::key(const Pair& sequences, const Scores& scores, const string& variant){
+    return hash_entry(sequences, scores, variant);
+}
+
+ResultCache::Shard& ResultCache::shard(const CacheKey& key){
+    return shards[key.high % shardCount];
+}
+
+void ResultCache::store(Shard& target, const CacheKey& key, const vector<Result>& results){
+    if(target.capacity==0 || target.entries.find(key)!=target.entries.end())
+        return;
+    if(target.entries.size()>=target.capacity){ //evict the least recently used entry
+        target.entries.erase(target.usage.back());
+        target.usage.pop_back();
+    }
+    target.usage.push_front(key);
+    target.entries.emplace(key, make_pair(results, target.usage.begin()));
+}
+
+bool ResultCache::find(const Pair& sequences, const Scores& scores, const string& variant, unsigned int ref_id, vector<Result>& results){
+    if(capacity==0){
+        misses++;
+        return false;
+    }
+    CacheKey k = key(sequences, scores, variant);
+    Shard& target = shard(k);
+    lock_guard<mutex> guard(target.lock);
+
+    auto entry = target.entries.find(k);
+    if(entry==target.entries.end()){
+        misses++;
+        return false;
+    }
+    hits++;
+    target.usage.splice(target.usage.begin(), target.usage, entry->second.second);  //it becomes the most recently used
+    for(size_t i=0;i<entry->second.first.size();i++){
+        results.push_back(entry->second.first[i]);
+        results.back().ref_id = ref_id;
+    }
+    return true;
+}
+
+void ResultCache::insert(const Pair& sequences, const Scores& scores, const string& variant, const vector<Result>& results){
+    if(capacity==0)
+        return;
+    CacheKey k = key(sequences, scores, variant);
+    Shard& target = shard(k);
+    lock_guard<mutex> guard(target.lock);
+    store(target, k, results);
+}
+
+void ResultCache::load(const string& path){
+    ifstream input(path.c_str(), ios::binary);
+    char magic[sizeof(CACHE_MAGIC)];
+
+    if(!input.is_open()) //the cache has not been saved yet
+        return;
+    if(!input.read(magic, sizeof(magic)))
+        throw runtime_error("Error: Invalid contents of the cache file...");
+    if(string(magic, sizeof(magic))!=string(CACHE_MAGIC, sizeof(CACHE_MAGIC)))
+        throw runtime_error("Error: Invalid contents of the cache file...");
+
+    long long int count = read_int(input);
+    for(long long int i=0;i<count;i++){
+        CacheKey k;
+        k.high = read_int(input);
+        k.low = read_int(input);
+        vector<Result> results(read_int(input));
+        for(size_t j=0;j<results.size();j++){
+            results[j].ref_id = 0;
+            results[j].score = read_int(input);
+            results[j].start = read_int(input);
+            results[j].stop = read_int(input);
+            results[j].result_pair.q = read_string(input);
+            results[j].result_pair.d = read_string(input);
+        }
+        Shard& target = shard(k);
+        lock_guard<mutex> guard(target.lock);
+        store(target, k, results);
+    }
+}
+
+void ResultCache::save(const string& path){
+    ofstream output(path.c_str(), ios::binary | ios::trunc);
+    if(!output.is_open())
+        throw ios_base::failure((string("Cache file ") + path + string(" cannot be opened.")).c_str());
+
+    for(size_t s=0;s<SHARDS;s++) //all the shards are locked, so that the count matches the entries that are written
+        shards[s].lock.lock();
+    long long int count = 0;
+    for(size_t s=0;s<SHARDS;s++)
+        count += shards[s].entries.size();
+    output.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    write_int(output, count);
+    for(size_t s=0;s<SHARDS;s++){
+        for(auto entry=shards[s].entries.begin();entry!=shards[s].entries.end();entry++){
+            const vector<Result>& results = entry->second.first;
+            write_int(output, entry->first.high);
+            write_int(output, entry->first.low);
+            write_int(output, results.size());
+            for(size_t j=0;j<results.size();j++){
+                write_int(output, results[j].score);
+                write_int(output, results[j].start);
+                write_int(output, results[j].stop);
+                write_string(output, results[j].result_pair.q);
+                write_string(output, results[j].result_pair.d);
+            }
+        }
+    }
+    for(size_t s=0;s<SHARDS;s++)
+        shards[s].lock.unlock();
+    output.close();
+}
+
+long long int ResultCache::getHits(void) const{
+    return hits;
+}
+
+long long int ResultCache::getMisses(void) const{
+    return misses;
+}
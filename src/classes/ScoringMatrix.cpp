@@ -0,0 +1,20 @@
+/**
+ * @file ScoringMatrix.cpp
+ */
+#include "ScoringMatrix.h"
+
+ScoringMatrix::ScoringMatrix(void) {
+    cells = 0;
+    rows = 0;
+    cols = 0;
+    stride = 0;
+}
+
+void ScoringMatrix::reshape(size_t rows, size_t columns){
+    const size_t cellsPerLine = MatrixArena::ALIGNMENT/sizeof(int);
+
+    this->rows = rows;
+    this->cols = columns;
+    this->stride = (columns + cellsPerLine - 1)/cellsPerLine*cellsPerLine;  //every row begins at a cache line
+    cells = (int*)arena.reserve(rows*stride*sizeof(int));
+}
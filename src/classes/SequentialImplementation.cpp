@@ -2,6 +2,7 @@
  * @file SequentialImplementation.cpp
  */
 #include "SequentialImplementation.h"
+#include "OptimumTracker.h"
 
 SequentialImplementation::SequentialImplementation(int argc, char* argv[]):
     Framework(argc, argv) {
@@ -14,16 +15,13 @@ SequentialImplementation::~SequentialImplementation() {
     delete statisticData.totalTracebackTime;
 }
 
-long long int SequentialImplementation::fill_scoring_matrix(Pair sequences, vector< vector<int> >& scoring_matrix, vector<Position>& max_pos){
+long long int SequentialImplementation::fill_scoring_matrix(Pair sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos){
 	int n1, n2, n3;
-	int max=0;
-	Position tmp_pos;
+	OptimumTracker tracker(algoScores.maxAlignments);
 	long long int cellsGreaterThanZero=0;
 
-	max_pos.clear();
-
 	for(size_t row=0;row<scoring_matrix.size();row++){ //for every row of scoring matrix
-		for(size_t col=0;col<scoring_matrix[row].size();col++){ //for every column of scoring matrix
+		for(size_t col=0;col<scoring_matrix.columns();col++){ //for every column of scoring matrix
 			if((row==0) || (col==0)){
 				scoring_matrix[row][col] = 0;
 			}
@@ -61,106 +59,60 @@ long long int SequentialImplementation::fill_scoring_matrix(Pair sequences, vect
 				cellsGreaterThanZero++;
 
 			//Search for the max value and save the Position x,y of max i matrix
-			if(scoring_matrix[row][col]>max){
-				max_pos.clear();
-				tmp_pos.row=row;
-				tmp_pos.column=col;
-				max_pos.push_back(tmp_pos);
-				max = scoring_matrix[row][col];
-			}
-			else if(scoring_matrix[row][col]==max){
-				tmp_pos.row=row;
-				tmp_pos.column=col;
-				max_pos.push_back(tmp_pos);
-			}
+			tracker.update(scoring_matrix[row][col], row, col);
 		}
 	}
+	tracker.collect(max_pos);
 	return cellsGreaterThanZero;
 }
 
 void SequentialImplementation::printStatistics(void){
-    cout << "A) Total pairs of sequences Q-D: " << data.size() << endl;
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
     cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
     cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
     cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
     cout << "E) Total time of calculating cells: " << *statisticData.calcCellsTime << " seconds" << endl;
     cout << "F) Total traceback time: " << *statisticData.totalTracebackTime << " seconds" << endl;
-    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellsGreaterThanZero/statisticData.totalTime << endl;
-    cout << "H) Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellsGreaterThanZero/(*statisticData.calcCellsTime) << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellUpdates/(*statisticData.calcCellsTime) << endl;
+    cout << "I) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "J) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
 }
 
-void SequentialImplementation::runAlgorithm(void){
+void SequentialImplementation::alignPairs(void){
     Result res;
+    ScoringMatrix scoring_matrix;  //reused for every pair
     long double time0 = getTime();
 	for(size_t i=0;i<data.size();i++){
-		vector< vector<int> > scoring_matrix(data[i].q.size()+1, vector<int>(data[i].d.size()+1));
         vector<Position> max_pos_vec;
 		results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+        PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+		scoring_matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+        allocate.stop();
 
 		long double time1 = getTime();
+        PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
         statisticData.cellsGreaterThanZero += fill_scoring_matrix(data[i], scoring_matrix, max_pos_vec);
+        fill.stop();
 		*statisticData.calcCellsTime += getTime() - time1;
+        if(!keepPair(i, max_pos_vec.empty() ? 0 : scoring_matrix[max_pos_vec[0].row][max_pos_vec[0].column]))
+            continue;
 
+        time1 = getTime();  //the clock is read once for all the tracebacks of the pair, since they are usually short
+        PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
 		for(size_t j=0;j<max_pos_vec.size();j++){
             res.ref_id = i;
 			res.score = scoring_matrix[max_pos_vec[j].row][max_pos_vec[j].column];
 			res.stop = max_pos_vec[j].column-1;
 			results[i].push_back(res);
-
-            time1 = getTime();
-			statisticData.totalTracebackSteps += traceback(1, max_pos_vec[j].row, max_pos_vec[j].column, data[i], scoring_matrix, results[i]);
-			*statisticData.totalTracebackTime += getTime() - time1;
-		}
-	}
-	statisticData.totalTime = getTime() - time0;
-}
-
-long long int SequentialImplementation::traceback(int steps, int start_row, int start_col, Pair sequences, vector< vector<int> >& scoring_matrix, vector<Result>& results_vec){
-	unsigned int index = results_vec.size()-1;
-	int n1, n2, n3;
-
-	//Compute values of left, up, and diagonally left cell of cell [start_row,start_col]
-	if(sequences.q[start_row-1]==sequences.d[start_col-1])			 //diagonally up left
-		n1 = scoring_matrix[start_row-1][start_col-1] + algoScores.matchScore;
-	else
-		n1 = scoring_matrix[start_row-1][start_col-1] + algoScores.mismatchScore;
-	n2 = scoring_matrix[start_row][start_col-1] + algoScores.gapScore;  //left
-	n3 = scoring_matrix[start_row-1][start_col] + algoScores.gapScore;  //up
-
-	//check if this cell have same value with diagonally left cell
-	if(scoring_matrix[start_row][start_col]==n1){  //diagonally
-		results_vec[index].result_pair.q = sequences.q[start_row-1] + results_vec[index].result_pair.q;
-		results_vec[index].result_pair.d = sequences.d[start_col-1] + results_vec[index].result_pair.d;
-		//if the diagonally left cell is zero then we are at first row,column,so end of recursion
-		if(scoring_matrix[start_row-1][start_col-1]==0){
-			results_vec[index].start = start_col-1;
-			return steps;
-		}
-		else//continue recursion
-			return traceback(steps+1, start_row-1, start_col-1, sequences, scoring_matrix, results_vec);
-	}
-	//check if this cell have same value with left cell
-	else if(scoring_matrix[start_row][start_col]==n2){ //left
-		results_vec[index].result_pair.q = "-" + results_vec[index].result_pair.q;
-		results_vec[index].result_pair.d = sequences.d[start_col-1] + results_vec[index].result_pair.d;
-		//if the  left cell is zero then we are at first column, so end of recursion
-		if(scoring_matrix[start_row][start_col-1]==0){
-			results_vec[index].start = start_col-1;
-			return steps;
-		}
-		else//continue recursion
-			return traceback(steps+1, start_row, start_col-1, sequences, scoring_matrix, results_vec);
-	}//check if this cell have same value with up cell
-	else if(scoring_matrix[start_row][start_col]==n3){ //up
-		results_vec[index].result_pair.q = sequences.q[start_row-1] + results_vec[index].result_pair.q;
-		results_vec[index].result_pair.d = "-" + results_vec[index].result_pair.d;
-		//if the  up cell is zero then we are at first row,so end of recursion
-		if(scoring_matrix[start_row-1][start_col]==0){
-			results_vec[index].start = start_col-1;
-			return steps;
+			statisticData.totalTracebackSteps += traceback(data[i], scoring_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
 		}
-		else//continue recursion
-			return traceback(steps+1, start_row-1, start_col, sequences, scoring_matrix, results_vec);
+        tracebacks.stop();
+		*statisticData.totalTracebackTime += getTime() - time1;
+        completeResults(i);
 	}
-	return 0;
+	statisticData.totalTime += getTime() - time0;
+	statisticData.matrixAllocations += scoring_matrix.getAllocations();
 }
@@ -0,0 +1,425 @@
+/**
+ * @file SimdBatchImplementation.cpp
+ */
+#include "SimdBatchImplementation.h"
+#include "OptimumTracker.h"
+#include <algorithm>
+#include <limits.h>
+
+SimdBatchImplementation::SimdBatchImplementation(int argc, char* argv[]):
+    Framework(argc, argv) {
+    statisticData.calcCellsTime = new long double[1];
+    statisticData.totalTracebackTime = new long double[1];
+    statisticData.calcCellsTime[0] = 0;
+    statisticData.totalTracebackTime[0] = 0;
+    batches8 = 0;
+    batches = 0;
+    promotedPairs = 0;
+    promotionCells = LLONG_MAX;
+    scalarPairs = 0;
+    laneCells = 0;
+    usefulCells = 0;
+    bias = max(0, -min(algoScores.matchScore, algoScores.mismatchScore));
+}
+
+SimdBatchImplementation::~SimdBatchImplementation() {
+    delete statisticData.calcCellsTime;
+    delete statisticData.totalTracebackTime;
+}
+
+bool SimdBatchImplementation::fits_in_batch(const Pair& sequences){
+#ifdef SIMD_SUPPORTED
+    //the SIMD kernel supports gap penalties (not rewards) and scores that fit in 16 bits
+    if(algoScores.gapScore>0 || abs(algoScores.matchScore)>=SHRT_MAX || abs(algoScores.mismatchScore)>=SHRT_MAX || abs(algoScores.gapScore)>=SHRT_MAX)
+        return false;
+    if((long long int)sequences.q.size()*sequences.d.size()>MAX_BATCH_CELLS)
+        return false;
+
+    //no cell can exceed the best score of a gapless alignment along the shortest sequence, so the lanes never saturate
+    long long int bound = (long long int)max(max(algoScores.matchScore, algoScores.mismatchScore), 0)*min(sequences.q.size(), sequences.d.size());
+    return bound<SHRT_MAX;
+#else
+    return false;  //compiled without SSE4.1/AVX2, so every pair is computed by the scalar process
+#endif
+}
+
+bool SimdBatchImplementation::fits_in_8_bits(void){
+    //the unsigned cells hold the scores increased by the bias, and the gap penalty is subtracted with saturation
+    return -algoScores.gapScore<=UCHAR_MAX && bias+max(max(algoScores.matchScore, algoScores.mismatchScore), 0)<UCHAR_MAX;
+}
+
+#ifdef SIMD_SUPPORTED
+long long int SimdBatchImplementation::fill_scoring_matrix_8(const size_t* pairs, unsigned int count, BatchScoringMatrix<unsigned char>& scoring_matrix,
+                                                             vector<Position>* max_pos, unsigned int& overflow){
+    const simd_vec vZero = simd_zero();
+    const simd_vec vBias = simd_set1_u8(bias);
+    const simd_vec vGap = simd_set1_u8(-algoScores.gapScore);
+    const simd_vec vMatch = simd_set1_u8(algoScores.matchScore + bias);
+    const simd_vec vMismatch = simd_set1_u8(algoScores.mismatchScore + bias);
+    simd_vec vMax = vZero;
+    size_t rows = 1, columns = 1;
+    long long int cellsGreaterThanZero = 0;
+
+    for(unsigned int l=0;l<count;l++){
+        rows = max(rows, data[pairs[l]].q.size()+1);
+        columns = max(columns, data[pairs[l]].d.size()+1);
+        max_pos[l].clear();
+    }
+    scoring_matrix.rows = rows;
+    scoring_matrix.columns = columns;
+    scoring_matrix.lanes = SIMD_LANES_8;
+    PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+    scoring_matrix.cells = (unsigned char*)scoring_matrix.arena.reserve(rows*columns*SIMD_LANES_8);
+    allocate.stop();
+
+    //interleave the symbols of the batch; the lanes beyond the end of a sequence (or without a pair) are masked
+    qSymbols8.assign(rows*SIMD_LANES_8, 0);
+    dSymbols8.assign(columns*SIMD_LANES_8, 0);
+    rowMask8.assign(rows*SIMD_LANES_8, 0);
+    columnMask8.assign(columns*SIMD_LANES_8, 0);
+    for(unsigned int l=0;l<count;l++){
+        const Pair& sequences = data[pairs[l]];
+        for(size_t row=1;row<=sequences.q.size();row++){
+            qSymbols8[row*SIMD_LANES_8 + l] = (unsigned char)sequences.q[row-1];
+            rowMask8[row*SIMD_LANES_8 + l] = UCHAR_MAX;
+        }
+        for(size_t col=1;col<=sequences.d.size();col++){
+            dSymbols8[col*SIMD_LANES_8 + l] = (unsigned char)sequences.d[col-1];
+            columnMask8[col*SIMD_LANES_8 + l] = UCHAR_MAX;
+        }
+    }
+
+    memset(scoring_matrix.cells, 0, columns*SIMD_LANES_8);  //row 0
+    for(size_t row=1;row<rows;row++){ //for every row of the scoring matrices
+        const unsigned char* up = &scoring_matrix.cells[(row-1)*columns*SIMD_LANES_8];
+        unsigned char* current = &scoring_matrix.cells[row*columns*SIMD_LANES_8];
+        const simd_vec vQ = simd_load(&qSymbols8[row*SIMD_LANES_8]);
+        const simd_vec vRowMask = simd_load(&rowMask8[row*SIMD_LANES_8]);
+        simd_vec vLeft = vZero;
+
+        simd_store(current, vZero);  //column 0
+        for(size_t col=1;col<columns;col++){ //for every column of the scoring matrices
+            //compute the cell of every lane for match, mismatch and gap; the subtraction of the bias stops the negative scores at zero
+            simd_vec vSub = simd_blend(vMismatch, vMatch, simd_cmpeq_u8(vQ, simd_load(&dSymbols8[col*SIMD_LANES_8])));
+            simd_vec vH = simd_subs_u8(simd_adds_u8(simd_load(up + (col-1)*SIMD_LANES_8), vSub), vBias);
+            vH = simd_max_u8(vH, simd_subs_u8(simd_load(up + col*SIMD_LANES_8), vGap));
+            vH = simd_max_u8(vH, simd_subs_u8(vLeft, vGap));
+            vH = simd_and(vH, simd_and(vRowMask, simd_load(&columnMask8[col*SIMD_LANES_8])));
+            simd_store(current + col*SIMD_LANES_8, vH);
+            vMax = simd_max_u8(vMax, vH);
+            vLeft = vH;
+
+            //How many cells have value>0
+            cellsGreaterThanZero += __builtin_popcount(simd_movemask(simd_cmpgt_u8(vH, vZero)));
+        }
+    }
+
+    //a lane may have saturated if its max value is so high that one more match could exceed 8 bits; its cells are not
+    //valid, so it is excluded from the statistics and the max scan, and it is computed again by the 16-bit kernel
+    unsigned char lanesMax[SIMD_LANES_8];
+    simd_store(lanesMax, vMax);
+    overflow = 0;
+    for(unsigned int l=0;l<count;l++){
+        if(lanesMax[l] > UCHAR_MAX - bias - max(max(algoScores.matchScore, algoScores.mismatchScore), 0)){
+            overflow |= 1u<<l;
+            for(size_t cell=l;cell<rows*columns*SIMD_LANES_8;cell+=SIMD_LANES_8)
+                cellsGreaterThanZero -= scoring_matrix.cells[cell]>0;
+            lanesMax[l] = 0;
+        }
+        else
+            usefulCells += (long long int)data[pairs[l]].q.size()*data[pairs[l]].d.size();
+    }
+    laneCells += (long long int)(rows-1)*(columns-1)*SIMD_LANES_8;
+
+    //Search for the cells with the max value of every lane (lanes whose max value is zero have nothing to align)
+    PhaseTimer scan(metrics, MAX_SCAN_PHASE);
+    vector<OptimumTracker> trackers(count, OptimumTracker(algoScores.maxAlignments));
+    vMax = simd_load(lanesMax);
+    vMax = simd_blend(simd_set1_u8(UCHAR_MAX), vMax, simd_cmpgt_u8(vMax, vZero));  //255 is never reached by a valid lane
+    for(size_t row=1;row<rows;row++){
+        const unsigned char* current = &scoring_matrix.cells[row*columns*SIMD_LANES_8];
+        for(size_t col=1;col<columns;col++){
+            unsigned int mask = simd_movemask(simd_cmpeq_u8(simd_load(current + col*SIMD_LANES_8), vMax)) & ~overflow;
+            while(mask){
+                unsigned int l = __builtin_ctz(mask);
+                trackers[l].update(current[col*SIMD_LANES_8 + l], row, col);
+                mask &= mask-1;
+            }
+        }
+    }
+    for(unsigned int l=0;l<count;l++)
+        trackers[l].collect(max_pos[l]);
+    return cellsGreaterThanZero;
+}
+
+long long int SimdBatchImplementation::fill_scoring_matrix(const size_t* pairs, unsigned int count, BatchScoringMatrix<short>& scoring_matrix, vector<Position>* max_pos){
+    const simd_vec vZero = simd_zero();
+    const simd_vec vGap = simd_set1_i16(algoScores.gapScore);
+    const simd_vec vMatch = simd_set1_i16(algoScores.matchScore);
+    const simd_vec vMismatch = simd_set1_i16(algoScores.mismatchScore);
+    simd_vec vMax = vZero;
+    size_t rows = 1, columns = 1;
+    long long int cellsGreaterThanZero = 0;
+
+    for(unsigned int l=0;l<count;l++){
+        rows = max(rows, data[pairs[l]].q.size()+1);
+        columns = max(columns, data[pairs[l]].d.size()+1);
+        max_pos[l].clear();
+    }
+    scoring_matrix.rows = rows;
+    scoring_matrix.columns = columns;
+    scoring_matrix.lanes = SIMD_LANES_16;
+    PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+    scoring_matrix.cells = (short*)scoring_matrix.arena.reserve(rows*columns*SIMD_LANES_16*sizeof(short));
+    allocate.stop();
+
+    //interleave the symbols of the batch; the lanes beyond the end of a sequence (or without a pair) are masked
+    qSymbols.assign(rows*SIMD_LANES_16, 0);
+    dSymbols.assign(columns*SIMD_LANES_16, 0);
+    rowMask.assign(rows*SIMD_LANES_16, 0);
+    columnMask.assign(columns*SIMD_LANES_16, 0);
+    for(unsigned int l=0;l<count;l++){
+        const Pair& sequences = data[pairs[l]];
+        for(size_t row=1;row<=sequences.q.size();row++){
+            qSymbols[row*SIMD_LANES_16 + l] = (unsigned char)sequences.q[row-1];
+            rowMask[row*SIMD_LANES_16 + l] = -1;
+        }
+        for(size_t col=1;col<=sequences.d.size();col++){
+            dSymbols[col*SIMD_LANES_16 + l] = (unsigned char)sequences.d[col-1];
+            columnMask[col*SIMD_LANES_16 + l] = -1;
+        }
+        usefulCells += (long long int)sequences.q.size()*sequences.d.size();
+    }
+    laneCells += (long long int)(rows-1)*(columns-1)*SIMD_LANES_16;
+
+    memset(scoring_matrix.cells, 0, columns*SIMD_LANES_16*sizeof(short));  //row 0
+    for(size_t row=1;row<rows;row++){ //for every row of the scoring matrices
+        const short* up = &scoring_matrix.cells[(row-1)*columns*SIMD_LANES_16];
+        short* current = &scoring_matrix.cells[row*columns*SIMD_LANES_16];
+        const simd_vec vQ = simd_load(&qSymbols[row*SIMD_LANES_16]);
+        const simd_vec vRowMask = simd_load(&rowMask[row*SIMD_LANES_16]);
+        simd_vec vLeft = vZero;
+
+        simd_store(current, vZero);  //column 0
+        for(size_t col=1;col<columns;col++){ //for every column of the scoring matrices
+            //compute the cell of every lane for match, mismatch and gap
+            simd_vec vSub = simd_blend(vMismatch, vMatch, simd_cmpeq_i16(vQ, simd_load(&dSymbols[col*SIMD_LANES_16])));
+            simd_vec vH = simd_adds_i16(simd_load(up + (col-1)*SIMD_LANES_16), vSub);
+            vH = simd_max_i16(vH, simd_adds_i16(simd_load(up + col*SIMD_LANES_16), vGap));
+            vH = simd_max_i16(vH, simd_adds_i16(vLeft, vGap));
+            vH = simd_max_i16(vH, vZero);
+            vH = simd_and(vH, simd_and(vRowMask, simd_load(&columnMask[col*SIMD_LANES_16])));
+            simd_store(current + col*SIMD_LANES_16, vH);
+            vMax = simd_max_i16(vMax, vH);
+            vLeft = vH;
+
+            //How many cells have value>0
+            cellsGreaterThanZero += __builtin_popcount(simd_movemask(simd_cmpgt_i16(vH, vZero)))/2;
+        }
+    }
+
+    //Search for the cells with the max value of every lane (lanes whose max value is zero have nothing to align)
+    PhaseTimer scan(metrics, MAX_SCAN_PHASE);
+    vector<OptimumTracker> trackers(count, OptimumTracker(algoScores.maxAlignments));
+    vMax = simd_blend(simd_set1_i16(-1), vMax, simd_cmpgt_i16(vMax, vZero));
+    for(size_t row=1;row<rows;row++){
+        const short* current = &scoring_matrix.cells[row*columns*SIMD_LANES_16];
+        for(size_t col=1;col<columns;col++){
+            unsigned int mask = simd_movemask(simd_cmpeq_i16(simd_load(current + col*SIMD_LANES_16), vMax));
+            while(mask){
+                unsigned int l = __builtin_ctz(mask)/2;
+                trackers[l].update(current[col*SIMD_LANES_16 + l], row, col);
+                mask &= ~(3u<<(2*l));
+            }
+        }
+    }
+    for(unsigned int l=0;l<count;l++)
+        trackers[l].collect(max_pos[l]);
+    return cellsGreaterThanZero;
+}
+#else
+long long int SimdBatchImplementation::fill_scoring_matrix_8(const size_t* pairs, unsigned int count, BatchScoringMatrix<unsigned char>& scoring_matrix,
+                                                             vector<Position>* max_pos, unsigned int& overflow){
+    return 0;  //never called, since fits_in_batch() rejects every pair
+}
+
+long long int SimdBatchImplementation::fill_scoring_matrix(const size_t* pairs, unsigned int count, BatchScoringMatrix<short>& scoring_matrix, vector<Position>* max_pos){
+    return 0;  //never called, since fits_in_batch() rejects every pair
+}
+#endif
+
+long long int SimdBatchImplementation::fill_scoring_matrix_scalar(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos){
+	int n1, n2, n3;
+	OptimumTracker tracker(algoScores.maxAlignments);
+	long long int cellsGreaterThanZero=0;
+
+	for(size_t row=0;row<scoring_matrix.size();row++){ //for every row of scoring matrix
+		for(size_t col=0;col<scoring_matrix.columns();col++){ //for every column of scoring matrix
+			if((row==0) || (col==0)){
+				scoring_matrix[row][col] = 0;
+			}
+			else{
+				//compute the cell for match, mismatch and gap
+				if(sequences.q[row-1]==sequences.d[col-1])
+					n1 = scoring_matrix[row-1][col-1] + algoScores.matchScore;
+				else
+					n1 = scoring_matrix[row-1][col-1] + algoScores.mismatchScore;
+				n2 = scoring_matrix[row-1][col] + algoScores.gapScore;
+				n3 = scoring_matrix[row][col-1] + algoScores.gapScore;
+
+				scoring_matrix[row][col] = max(max(0, n1), max(n2, n3));
+			}
+			//How many cells have value>0
+			if(scoring_matrix[row][col]>0)
+				cellsGreaterThanZero++;
+
+			//Search for the max value and save the Position x,y of max i matrix
+			tracker.update(scoring_matrix[row][col], row, col);
+		}
+	}
+	tracker.collect(max_pos);
+	return cellsGreaterThanZero;
+}
+
+void SimdBatchImplementation::printStatistics(void){
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
+    cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
+    cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
+    cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
+    cout << "E) Total time of calculating cells: " << *statisticData.calcCellsTime << " seconds" << endl;
+    cout << "F) Total traceback time: " << *statisticData.totalTracebackTime << " seconds" << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellUpdates/(*statisticData.calcCellsTime) << endl;
+    cout << "I) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "J) Batches computed with the SIMD kernels (8-bit/16-bit): " << batches8 << "/" << batches << endl;
+    cout << "K) Pairs computed again with 16 bits after overflowing 8 bits: " << promotedPairs << endl;
+    cout << "L) Pairs computed without the SIMD kernels: " << scalarPairs << endl;
+    cout << "M) Occupancy of the SIMD lanes: " << (laneCells>0 ? (double)usefulCells/laneCells : 0) << endl;
+    cout << "N) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
+}
+
+template<class Matrix>
+void SimdBatchImplementation::trace_pair(size_t i, const Matrix& scoring_matrix, const vector<Position>& max_pos){
+    Result res;
+    if(!keepPair(i, max_pos.empty() ? 0 : scoring_matrix(max_pos[0].row, max_pos[0].column)))
+        return;
+    long double time1 = getTime();  //the clock is read once for all the tracebacks of the pair, since they are usually short
+    PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+    for(size_t j=0;j<max_pos.size();j++){
+        res.ref_id = i;
+        res.score = scoring_matrix(max_pos[j].row, max_pos[j].column);
+        res.stop = max_pos[j].column-1;
+        results[i].push_back(res);
+        statisticData.totalTracebackSteps += traceback(data[i], scoring_matrix, max_pos[j].row, max_pos[j].column, results[i].back());
+    }
+    tracebacks.stop();
+    *statisticData.totalTracebackTime += getTime() - time1;
+    completeResults(i);
+}
+
+void SimdBatchImplementation::alignPairs(void){
+    BatchScoringMatrix<unsigned char> batch_matrix8;  //all the matrices are reused for every batch/pair
+    BatchScoringMatrix<short> batch_matrix;
+    ScoringMatrix scoring_matrix;
+    vector<size_t> order(data.size()), batched8, batched, scalar, duplicates;
+    long double time0 = getTime();
+
+    //pairs of similar sizes are placed in the same batch, so that few cells are wasted in padding,
+    //and identical pairs become neighbours, so that only the first of them is aligned
+    for(size_t i=0;i<data.size();i++)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b){
+        if(data[a].q.size()!=data[b].q.size())
+            return data[a].q.size()<data[b].q.size();
+        if(data[a].d.size()!=data[b].d.size())
+            return data[a].d.size()<data[b].d.size();
+        return data[a].q<data[b].q || (data[a].q==data[b].q && data[a].d<data[b].d);
+    });
+
+    for(size_t k=0;k<order.size();k++){
+        size_t i = order[k];
+        results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(k>0 && data[i].q==data[order[k-1]].q && data[i].d==data[order[k-1]].d)
+            duplicates.push_back(i);  //its alignments will be found in the cache
+        else if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+        else if(fits_in_batch(data[i]))
+            (fits_in_8_bits() && (long long int)(data[i].q.size()*data[i].d.size())<promotionCells ? batched8 : batched).push_back(i);
+        else
+            scalar.push_back(i);
+    }
+
+#ifdef SIMD_SUPPORTED
+    //the 8-bit kernel computes twice as many pairs per batch; the pairs that overflow it are promoted to the 16-bit batches
+    vector<Position> max_pos_vec[SIMD_LANES_8];
+    for(size_t first=0;first<batched8.size();first+=SIMD_LANES_8){
+        if((long long int)(data[batched8[first]].q.size()*data[batched8[first]].d.size())>=promotionCells){ //the rest are expected to overflow too
+            batched.insert(batched.end(), batched8.begin() + first, batched8.end());
+            break;
+        }
+        unsigned int count = min(batched8.size()-first, (size_t)SIMD_LANES_8), overflow;
+
+        long double time1 = getTime();
+        PhaseTimer fill(metrics, FILL_PHASE);
+        statisticData.cellsGreaterThanZero += fill_scoring_matrix_8(&batched8[first], count, batch_matrix8, max_pos_vec, overflow);
+        fill.stop();
+        *statisticData.calcCellsTime += getTime() - time1;
+        batches8++;
+
+        for(unsigned int l=0;l<count;l++){ //every lane is traced back separately
+            if(overflow & (1u<<l)){
+                batched.push_back(batched8[first+l]);
+                promotedPairs++;
+                continue;
+            }
+            batch_matrix8.lane = l;
+            trace_pair(batched8[first+l], batch_matrix8, max_pos_vec[l]);
+        }
+        if(2*__builtin_popcount(overflow)>count){ //the pairs are sorted by size, so the larger ones would overflow as well
+            for(unsigned int l=0;l<count;l++)
+                promotionCells = min(promotionCells, (long long int)(data[batched8[first+l]].q.size()*data[batched8[first+l]].d.size()));
+        }
+    }
+
+    for(size_t first=0;first<batched.size();first+=SIMD_LANES_16){
+        unsigned int count = min(batched.size()-first, (size_t)SIMD_LANES_16);
+
+        long double time1 = getTime();
+        PhaseTimer fill(metrics, FILL_PHASE);
+        statisticData.cellsGreaterThanZero += fill_scoring_matrix(&batched[first], count, batch_matrix, max_pos_vec);
+        fill.stop();
+        *statisticData.calcCellsTime += getTime() - time1;
+        batches++;
+
+        for(unsigned int l=0;l<count;l++){ //every lane is traced back separately
+            batch_matrix.lane = l;
+            trace_pair(batched[first+l], batch_matrix, max_pos_vec[l]);
+        }
+    }
+#endif
+
+    auto align_scalar = [&](size_t i){
+        vector<Position> max_pos;
+
+        long double time1 = getTime();
+        PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+        scoring_matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+        allocate.stop();
+        PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
+        statisticData.cellsGreaterThanZero += fill_scoring_matrix_scalar(data[i], scoring_matrix, max_pos);
+        fill.stop();
+        *statisticData.calcCellsTime += getTime() - time1;
+        scalarPairs++;
+
+        trace_pair(i, scoring_matrix, max_pos);
+    };
+    for(size_t k=0;k<scalar.size();k++)
+        align_scalar(scalar[k]);
+
+    //the duplicates whose alignments are no longer in the cache (it is disabled, or they were evicted) are computed by the scalar process
+    for(size_t k=0;k<duplicates.size();k++)
+        if(!reuseResults(duplicates[k]))
+            align_scalar(duplicates[k]);
+    statisticData.totalTime += getTime() - time0;
+    statisticData.matrixAllocations += batch_matrix8.arena.getAllocations() + batch_matrix.arena.getAllocations() + scoring_matrix.getAllocations();
+}
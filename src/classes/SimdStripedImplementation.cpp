@@ -0,0 +1,441 @@
+/**
+ * @file SimdStripedImplementation.cpp
+ */
+#include "SimdStripedImplementation.h"
+#include "OptimumTracker.h"
+#include <algorithm>
+#include <limits.h>
+
+SimdStripedImplementation::SimdStripedImplementation(int argc, char* argv[]):
+    Framework(argc, argv) {
+    statisticData.calcCellsTime = new long double[1];
+    statisticData.totalTracebackTime = new long double[1];
+    statisticData.calcCellsTime[0] = 0;
+    statisticData.totalTracebackTime[0] = 0;
+    scalarPairs = 0;
+    pairs8 = 0;
+    pairs16 = 0;
+    profiles = 0;
+    scoreRate = 0;
+    bias = max(0, -min(algoScores.matchScore, algoScores.mismatchScore));
+}
+
+SimdStripedImplementation::~SimdStripedImplementation() {
+    delete statisticData.calcCellsTime;
+    delete statisticData.totalTracebackTime;
+}
+
+#ifdef SIMD_SUPPORTED
+void SimdStripedImplementation::select_query(const PackedSequence& q){
+    //the profiles depend only on the Q sequence, so they are reused by consecutive pairs with the same Q (e.g. a database search)
+    if(profiles>0 && q==profileQuery)
+        return;
+
+    const unsigned int segments = (q.size() + SIMD_LANES_16 - 1)/SIMD_LANES_16;
+    const unsigned int segments8 = (q.size() + SIMD_LANES_8 - 1)/SIMD_LANES_8;
+    profile.clear();
+    profile8.clear();
+    for(int i=0;i<256;i++){
+        profileIndex[i] = -1;
+        profileIndex8[i] = -1;
+    }
+
+    rowMask.assign((size_t)segments*SIMD_LANES_16, -1);
+    for(size_t i=q.size();i<rowMask.size();i++)
+        rowMask[(i%segments)*SIMD_LANES_16 + i/segments] = 0;
+    rowMask8.assign((size_t)segments8*SIMD_LANES_8, 0xFF);
+    for(size_t i=q.size();i<rowMask8.size();i++)
+        rowMask8[(i%segments8)*SIMD_LANES_8 + i/segments8] = 0;
+    profileQuery = q.str();
+    profiles++;
+}
+
+const unsigned char* SimdStripedImplementation::profile8_of(const PackedSequence& q, unsigned char symbol, unsigned int segments){
+    if(profileIndex8[symbol]<0){
+        size_t offset = profile8.size();
+        profileIndex8[symbol] = offset;
+        profile8.resize(offset + (size_t)segments*SIMD_LANES_8);
+
+        for(unsigned int s=0;s<segments;s++){
+            for(int l=0;l<SIMD_LANES_8;l++){
+                size_t i = (size_t)l*segments + s;  //the row of the query which corresponds to this lane
+                int value;
+                if(i>=q.size())  //padding, which is masked anyway
+                    value = 0;
+                else if((unsigned char)q.symbol(i)==symbol)
+                    value = algoScores.matchScore + bias;
+                else
+                    value = algoScores.mismatchScore + bias;
+                profile8[offset + s*SIMD_LANES_8 + l] = value;
+            }
+        }
+    }
+    return &profile8[profileIndex8[symbol]];
+}
+
+const short* SimdStripedImplementation::profile_of(const PackedSequence& q, unsigned char symbol, unsigned int segments){
+    if(profileIndex[symbol]<0){
+        size_t offset = profile.size();
+        profileIndex[symbol] = offset;
+        profile.resize(offset + (size_t)segments*SIMD_LANES_16);
+
+        for(unsigned int s=0;s<segments;s++){
+            for(int l=0;l<SIMD_LANES_16;l++){
+                size_t i = (size_t)l*segments + s;  //the row of the query which corresponds to this lane
+                short value;
+                if(i>=q.size())  //padding, which never produces a positive cell
+                    value = SHRT_MIN;
+                else if((unsigned char)q.symbol(i)==symbol)
+                    value = algoScores.matchScore;
+                else
+                    value = algoScores.mismatchScore;
+                profile[offset + s*SIMD_LANES_16 + l] = value;
+            }
+        }
+    }
+    return &profile[profileIndex[symbol]];
+}
+
+bool SimdStripedImplementation::fill_scoring_matrix_8(const Pair& sequences, StripedScoringMatrix<unsigned char>& scoring_matrix, vector<Position>& max_pos, long long int& cells){
+    const unsigned int segments = (sequences.q.size() + SIMD_LANES_8 - 1)/SIMD_LANES_8;
+    const size_t stride = (size_t)segments*SIMD_LANES_8;
+    const simd_vec vZero = simd_zero();
+    const simd_vec vBias = simd_set1_u8(bias);
+    const simd_vec vGap = simd_set1_u8(-algoScores.gapScore);  //a penalty, which is subtracted
+    simd_vec vMax = vZero;
+    long long int cellsGreaterThanZero = 0;
+
+    max_pos.clear();
+    if(sequences.q.empty() || sequences.d.empty()){ //the matrix has no cells besides row 0 and column 0, so there is nothing to align
+        cells = 0;
+        return true;
+    }
+    scoring_matrix.rows = sequences.q.size()+1;
+    scoring_matrix.columns = sequences.d.size()+1;
+    scoring_matrix.segments = segments;
+    scoring_matrix.lanes = SIMD_LANES_8;
+    PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+    scoring_matrix.cells = (unsigned char*)scoring_matrix.arena.reserve(stride*scoring_matrix.columns);
+    allocate.stop();
+    memset(scoring_matrix.cells, 0, stride);  //column 0, the rest of the cells are always written before they are read
+    select_query(sequences.q);
+
+    for(size_t col=1;col<scoring_matrix.columns;col++){ //for every column of scoring matrix
+        const unsigned char* vP = profile8_of(sequences.q, sequences.d.symbol(col-1), segments);
+        const unsigned char* prevColumn = &scoring_matrix.cells[(col-1)*stride];
+        unsigned char* column = &scoring_matrix.cells[col*stride];
+        simd_vec vF = vZero;
+        simd_vec vH = simd_shift_lanes_u8(simd_load(prevColumn + (segments-1)*SIMD_LANES_8)); //diagonal cells of segment 0
+
+        for(unsigned int s=0;s<segments;s++){
+            //the lanes are unsigned, so subtracting the bias (or a gap) stops at zero, which is the lower bound of every cell
+            vH = simd_subs_u8(simd_adds_u8(vH, simd_load(vP + s*SIMD_LANES_8)), vBias);
+            vH = simd_max_u8(vH, simd_subs_u8(simd_load(prevColumn + s*SIMD_LANES_8), vGap));
+            vH = simd_max_u8(vH, vF);
+            vH = simd_and(vH, simd_load(&rowMask8[s*SIMD_LANES_8]));
+            simd_store(column + s*SIMD_LANES_8, vH);
+            vMax = simd_max_u8(vMax, vH);
+
+            vF = simd_subs_u8(vH, vGap);
+            vH = simd_load(prevColumn + s*SIMD_LANES_8);
+        }
+
+        //lazy-F loop: propagate the gaps from above across the lanes, until they cannot improve any cell
+        unsigned int s = 0;
+        vF = simd_and(simd_shift_lanes_u8(vF), simd_load(&rowMask8[0]));
+        while(simd_movemask(simd_cmpgt_u8(vF, simd_load(column + s*SIMD_LANES_8)))){
+            vH = simd_max_u8(simd_load(column + s*SIMD_LANES_8), vF);
+            simd_store(column + s*SIMD_LANES_8, vH);
+            vMax = simd_max_u8(vMax, vH);
+
+            vF = simd_subs_u8(vH, vGap);
+            if(++s==segments){
+                s = 0;
+                vF = simd_shift_lanes_u8(vF);
+            }
+            vF = simd_and(vF, simd_load(&rowMask8[s*SIMD_LANES_8])); //no gaps towards the padding lanes
+        }
+
+        //How many cells have value>0
+        for(s=0;s<segments;s++)
+            cellsGreaterThanZero += __builtin_popcount(simd_movemask(simd_cmpgt_u8(simd_load(column + s*SIMD_LANES_8), vZero)));
+    }
+
+    //a diagonal step saturates only if it exceeds 255 before the bias is subtracted, which needs a cell above this limit
+    int maxCell = simd_hmax_u8(vMax);
+    if(maxCell > 255 - bias - max(algoScores.matchScore, 0))
+        return false;
+    cells = cellsGreaterThanZero;
+    if(maxCell==0) //nothing to align
+        return true;
+
+    //Search for the cells with the max value, and save them in row-major order like the other implementations
+    PhaseTimer scan(metrics, MAX_SCAN_PHASE);
+    OptimumTracker tracker(algoScores.maxAlignments);
+    vMax = simd_set1_u8(maxCell);
+    for(size_t col=1;col<scoring_matrix.columns;col++){
+        const unsigned char* column = &scoring_matrix.cells[col*stride];
+        for(unsigned int s=0;s<segments;s++){
+            unsigned int mask = simd_movemask(simd_cmpeq_u8(simd_load(column + s*SIMD_LANES_8), vMax));
+            while(mask){
+                unsigned int l = __builtin_ctz(mask);
+                tracker.update(maxCell, l*segments + s + 1, col);
+                mask &= mask-1;
+            }
+        }
+    }
+    tracker.collect(max_pos);
+    return true;
+}
+
+bool SimdStripedImplementation::fill_scoring_matrix(const Pair& sequences, StripedScoringMatrix<short>& scoring_matrix, vector<Position>& max_pos, long long int& cells){
+    const unsigned int segments = (sequences.q.size() + SIMD_LANES_16 - 1)/SIMD_LANES_16;
+    const size_t stride = (size_t)segments*SIMD_LANES_16;
+    const simd_vec vZero = simd_zero();
+    const simd_vec vGap = simd_set1_i16(algoScores.gapScore);
+    simd_vec vMax = vZero;
+    long long int cellsGreaterThanZero = 0;
+
+    max_pos.clear();
+    if(sequences.q.empty() || sequences.d.empty()){ //the matrix has no cells besides row 0 and column 0, so there is nothing to align
+        cells = 0;
+        return true;
+    }
+    scoring_matrix.rows = sequences.q.size()+1;
+    scoring_matrix.columns = sequences.d.size()+1;
+    scoring_matrix.segments = segments;
+    scoring_matrix.lanes = SIMD_LANES_16;
+    PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+    scoring_matrix.cells = (short*)scoring_matrix.arena.reserve(stride*scoring_matrix.columns*sizeof(short));
+    allocate.stop();
+    memset(scoring_matrix.cells, 0, stride*sizeof(short));  //column 0, the rest of the cells are always written before they are read
+    select_query(sequences.q);
+
+    for(size_t col=1;col<scoring_matrix.columns;col++){ //for every column of scoring matrix
+        const short* vP = profile_of(sequences.q, sequences.d.symbol(col-1), segments);
+        const short* prevColumn = &scoring_matrix.cells[(col-1)*stride];
+        short* column = &scoring_matrix.cells[col*stride];
+        simd_vec vF = vZero;
+        simd_vec vH = simd_shift_lanes_i16(simd_load(prevColumn + (segments-1)*SIMD_LANES_16)); //diagonal cells of segment 0
+
+        for(unsigned int s=0;s<segments;s++){
+            //compute the cell for match/mismatch, gap from the left and gap from above
+            vH = simd_adds_i16(vH, simd_load(vP + s*SIMD_LANES_16));
+            vH = simd_max_i16(vH, simd_adds_i16(simd_load(prevColumn + s*SIMD_LANES_16), vGap));
+            vH = simd_max_i16(vH, vF);
+            vH = simd_max_i16(vH, vZero);
+            vH = simd_and(vH, simd_load(&rowMask[s*SIMD_LANES_16]));
+            simd_store(column + s*SIMD_LANES_16, vH);
+            vMax = simd_max_i16(vMax, vH);
+
+            vF = simd_adds_i16(vH, vGap);
+            vH = simd_load(prevColumn + s*SIMD_LANES_16);
+        }
+
+        //lazy-F loop: propagate the gaps from above across the lanes, until they cannot improve any cell
+        unsigned int s = 0;
+        vF = simd_and(simd_shift_lanes_i16(vF), simd_load(&rowMask[0]));
+        while(simd_movemask(simd_cmpgt_i16(vF, simd_load(column + s*SIMD_LANES_16)))){
+            vH = simd_max_i16(simd_load(column + s*SIMD_LANES_16), vF);
+            simd_store(column + s*SIMD_LANES_16, vH);
+            vMax = simd_max_i16(vMax, vH);
+
+            vF = simd_adds_i16(vH, vGap);
+            if(++s==segments){
+                s = 0;
+                vF = simd_shift_lanes_i16(vF);
+            }
+            vF = simd_and(vF, simd_load(&rowMask[s*SIMD_LANES_16])); //no gaps towards the padding lanes
+        }
+
+        //How many cells have value>0
+        for(s=0;s<segments;s++)
+            cellsGreaterThanZero += __builtin_popcount(simd_movemask(simd_cmpgt_i16(simd_load(column + s*SIMD_LANES_16), vZero)))/2;
+    }
+
+    short maxCell = simd_hmax_i16(vMax);
+    if(maxCell==SHRT_MAX) //saturated, the scores do not fit in 16 bits
+        return false;
+    cells = cellsGreaterThanZero;
+    if(maxCell==0) //nothing to align
+        return true;
+
+    //Search for the cells with the max value, and save them in row-major order like the other implementations
+    PhaseTimer scan(metrics, MAX_SCAN_PHASE);
+    OptimumTracker tracker(algoScores.maxAlignments);
+    vMax = simd_set1_i16(maxCell);
+    for(size_t col=1;col<scoring_matrix.columns;col++){
+        const short* column = &scoring_matrix.cells[col*stride];
+        for(unsigned int s=0;s<segments;s++){
+            unsigned int mask = simd_movemask(simd_cmpeq_i16(simd_load(column + s*SIMD_LANES_16), vMax));
+            while(mask){
+                unsigned int l = __builtin_ctz(mask)/2;
+                tracker.update(maxCell, l*segments + s + 1, col);
+                mask &= ~(3u<<(2*l));
+            }
+        }
+    }
+    tracker.collect(max_pos);
+    return true;
+}
+#else
+void SimdStripedImplementation::select_query(const PackedSequence& q){
+}
+
+const unsigned char* SimdStripedImplementation::profile8_of(const PackedSequence& q, unsigned char symbol, unsigned int segments){
+    return 0;
+}
+
+const short* SimdStripedImplementation::profile_of(const PackedSequence& q, unsigned char symbol, unsigned int segments){
+    return 0;
+}
+
+bool SimdStripedImplementation::fill_scoring_matrix_8(const Pair& sequences, StripedScoringMatrix<unsigned char>& scoring_matrix, vector<Position>& max_pos, long long int& cells){
+    return false;  //compiled without SSE4.1/AVX2, so every pair is computed by the scalar process
+}
+
+bool SimdStripedImplementation::fill_scoring_matrix(const Pair& sequences, StripedScoringMatrix<short>& scoring_matrix, vector<Position>& max_pos, long long int& cells){
+    return false;  //compiled without SSE4.1/AVX2, so every pair is computed by the scalar process
+}
+#endif
+
+int SimdStripedImplementation::diagonal_score(const Pair& sequences){
+    int score = 0, best = 0;
+    size_t length = min(sequences.q.size(), sequences.d.size());
+    for(size_t k=0;k<length;k++){ //the best segment of the main diagonal, i.e. a local alignment without gaps
+        score = max(0, score + (sequences.q[k]==sequences.d[k] ? algoScores.matchScore : algoScores.mismatchScore));
+        best = max(best, score);
+    }
+    return best;
+}
+
+long long int SimdStripedImplementation::fill_scoring_matrix_scalar(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos){
+	int n1, n2, n3;
+	OptimumTracker tracker(algoScores.maxAlignments);
+	long long int cellsGreaterThanZero=0;
+
+	for(size_t row=0;row<scoring_matrix.size();row++){ //for every row of scoring matrix
+		for(size_t col=0;col<scoring_matrix.columns();col++){ //for every column of scoring matrix
+			if((row==0) || (col==0)){
+				scoring_matrix[row][col] = 0;
+			}
+			else{
+				//compute the cell for match, mismatch and gap
+				if(sequences.q[row-1]==sequences.d[col-1])
+					n1 = scoring_matrix[row-1][col-1] + algoScores.matchScore;
+				else
+					n1 = scoring_matrix[row-1][col-1] + algoScores.mismatchScore;
+				n2 = scoring_matrix[row-1][col] + algoScores.gapScore;
+				n3 = scoring_matrix[row][col-1] + algoScores.gapScore;
+
+				scoring_matrix[row][col] = max(max(0, n1), max(n2, n3));
+			}
+			//How many cells have value>0
+			if(scoring_matrix[row][col]>0)
+				cellsGreaterThanZero++;
+
+			//Search for the max value and save the Position x,y of max i matrix
+			tracker.update(scoring_matrix[row][col], row, col);
+		}
+	}
+	tracker.collect(max_pos);
+	return cellsGreaterThanZero;
+}
+
+void SimdStripedImplementation::printStatistics(void){
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
+    cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
+    cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
+    cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
+    cout << "E) Total time of calculating cells: " << *statisticData.calcCellsTime << " seconds" << endl;
+    cout << "F) Total traceback time: " << *statisticData.totalTracebackTime << " seconds" << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cell Updates Per Second (CUPS) based on time of calculating cells: " << (double)statisticData.cellUpdates/(*statisticData.calcCellsTime) << endl;
+    cout << "I) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "J) Pairs computed with 8-bit/16-bit/32-bit cells: " << pairs8 << "/" << pairs16 << "/" << scalarPairs << endl;
+    cout << "K) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
+    cout << "L) Query profiles built: " << profiles << endl;
+}
+
+void SimdStripedImplementation::alignPairs(void){
+    Result res;
+    StripedScoringMatrix<unsigned char> narrow_matrix;  //all the matrices are reused for every pair
+    StripedScoringMatrix<short> striped_matrix;
+    ScoringMatrix scoring_matrix;
+    long double time0 = getTime();
+
+    //the SIMD kernels support gap penalties (not rewards) and scores that fit in their cells
+    bool simdScores = algoScores.gapScore<=0 && abs(algoScores.matchScore)<SHRT_MAX &&
+                      abs(algoScores.mismatchScore)<SHRT_MAX && abs(algoScores.gapScore)<SHRT_MAX;
+    bool simdScores8 = algoScores.gapScore<=0 && -algoScores.gapScore<=UCHAR_MAX && bias + max(algoScores.matchScore, 0)<UCHAR_MAX;
+
+	for(size_t i=0;i<data.size();i++){
+        vector<Position> max_pos_vec;
+        long long int cells = 0;
+		results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+
+		long double time1 = getTime();
+        PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
+        int width;  //the bits of the cells, which are widened only if the scores of the pair overflow them
+        size_t length = min(data[i].q.size(), data[i].d.size());
+        int lower = (simdScores8 || simdScores) ? diagonal_score(data[i]) : 0;  //the kernels that it would surely overflow are skipped
+        bool narrow = max((double)lower, scoreRate*length)<=UCHAR_MAX - bias - max(algoScores.matchScore, 0);  //or probably, for 8 bits
+        if(simdScores8 && narrow && fill_scoring_matrix_8(data[i], narrow_matrix, max_pos_vec, cells)){
+            width = 8;
+            pairs8++;
+        }
+        else if(simdScores && lower<SHRT_MAX && fill_scoring_matrix(data[i], striped_matrix, max_pos_vec, cells)){
+            width = 16;
+            pairs16++;
+        }
+        else{
+            PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+            scoring_matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+            allocate.stop();
+            cells = fill_scoring_matrix_scalar(data[i], scoring_matrix, max_pos_vec);
+            width = 32;
+            scalarPairs++;
+        }
+        fill.stop();
+        statisticData.cellsGreaterThanZero += cells;
+		*statisticData.calcCellsTime += getTime() - time1;
+        int score = 0;
+        if(!max_pos_vec.empty()){
+            const Position& top = max_pos_vec[0];
+            score = width==8 ? narrow_matrix(top.row, top.column) :
+                    width==16 ? striped_matrix(top.row, top.column) : scoring_matrix[top.row][top.column];
+        }
+        if(length>0)
+            scoreRate += ((double)score/length - scoreRate)/8;
+        if(!keepPair(i, score))
+            continue;
+
+        time1 = getTime();  //the clock is read once for all the tracebacks of the pair, since they are usually short
+        PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+		for(size_t j=0;j<max_pos_vec.size();j++){
+            res.ref_id = i;
+			res.stop = max_pos_vec[j].column-1;
+			results[i].push_back(res);
+
+            if(width==8){
+                results[i].back().score = narrow_matrix(max_pos_vec[j].row, max_pos_vec[j].column);
+                statisticData.totalTracebackSteps += traceback(data[i], narrow_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
+            }
+            else if(width==16){
+                results[i].back().score = striped_matrix(max_pos_vec[j].row, max_pos_vec[j].column);
+                statisticData.totalTracebackSteps += traceback(data[i], striped_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
+            }
+            else{
+                results[i].back().score = scoring_matrix[max_pos_vec[j].row][max_pos_vec[j].column];
+                statisticData.totalTracebackSteps += traceback(data[i], scoring_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
+            }
+		}
+        tracebacks.stop();
+		*statisticData.totalTracebackTime += getTime() - time1;
+        completeResults(i);
+	}
+	statisticData.totalTime += getTime() - time0;
+	statisticData.matrixAllocations += narrow_matrix.arena.getAllocations() + striped_matrix.arena.getAllocations() + scoring_matrix.getAllocations();
+}
@@ -0,0 +1,177 @@
+/**
+ * @file ThreadPool.cpp
+ */
+#include "ThreadPool.h"
+#include <stdint.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/** The pool whose worker is the calling thread (null for the threads that are not workers). */
+static thread_local const ThreadPool* currentPool = 0;
+
+/** The number of the calling thread in the {@link currentPool}. */
+static thread_local unsigned int currentIndex = 0;
+
+TaskQueue::TaskQueue(size_t capacity) {
+    size_t size = 2;
+    while(size<capacity)
+        size *= 2;
+    slots.reset(new Slot[size]);
+    for(size_t i=0;i<size;i++){
+        slots[i].sequence.store(i, memory_order_relaxed);
+        slots[i].task = 0;
+    }
+    mask = size - 1;
+    tail.store(0, memory_order_relaxed);
+    head.store(0, memory_order_relaxed);
+}
+
+TaskQueue::~TaskQueue(void) {
+    function<void()>* task;
+    while(pop(task))
+        delete task;
+}
+
+bool TaskQueue::push(function<void()>* task){
+    size_t position = tail.load(memory_order_relaxed);
+    Slot* slot;
+    while(true){
+        slot = &slots[position & mask];
+        intptr_t difference = (intptr_t)slot->sequence.load(memory_order_acquire) - (intptr_t)position;
+        if(difference==0){ //the slot is free, so it is claimed if no other producer claimed it first
+            if(tail.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                break;
+        }
+        else if(difference<0) //the slot still holds a task from the previous round of the ring
+            return false;
+        else
+            position = tail.load(memory_order_relaxed);
+    }
+    slot->task = task;
+    slot->sequence.store(position + 1, memory_order_release);  //the task is visible to the consumers
+    return true;
+}
+
+bool TaskQueue::pop(function<void()>*& task){
+    size_t position = head.load(memory_order_relaxed);
+    Slot* slot;
+    while(true){
+        slot = &slots[position & mask];
+        intptr_t difference = (intptr_t)slot->sequence.load(memory_order_acquire) - (intptr_t)(position + 1);
+        if(difference==0){ //the slot holds a task, so it is claimed if no other consumer claimed it first
+            if(head.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                break;
+        }
+        else if(difference<0) //the slot has not been written yet
+            return false;
+        else
+            position = head.load(memory_order_relaxed);
+    }
+    task = slot->task;
+    slot->sequence.store(position + mask + 1, memory_order_release);  //the slot is free for the next round of the ring
+    return true;
+}
+
+ThreadPool::ThreadPool(unsigned int workers, bool pin):
+    queue(QUEUE_CAPACITY), queued(0), sleeping(0), waiting(0), executed(0), pinned(0), stopping(false), pin(pin) {
+    try{
+        for(unsigned int i=0;i<workers;i++)
+            this->workers.push_back(thread(&ThreadPool::run, this, i));
+    }catch(...){
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for(size_t i=0;i<this->workers.size();i++)
+            this->workers[i].join();
+        throw;
+    }
+}
+
+ThreadPool::~ThreadPool(void) {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for(size_t i=0;i<workers.size();i++)
+        workers[i].join();
+}
+
+unsigned int ThreadPool::index(void) const {
+    return currentPool==this ? currentIndex : workers.size();
+}
+
+void ThreadPool::notify_waiting(void){
+    atomic_thread_fence(memory_order_seq_cst);  //the task (or the future it made ready) is visible before the waiting threads are counted
+    if(waiting.load()>0){
+        lock_guard<mutex> guard(lock);
+        progress.notify_all();
+    }
+}
+
+void ThreadPool::post(function<void()> task){
+    function<void()>* copy = new function<void()>(move(task));
+    queued++;
+    if(!queue.push(copy)){ //the queue is full, so the caller executes the task itself
+        queued--;
+        (*copy)();
+        delete copy;
+        executed++;
+        notify_waiting();
+        return;
+    }
+    //a worker increases the sleeping workers before it checks the queued tasks, so one of the two threads sees the other
+    if(sleeping.load()>0){
+        lock_guard<mutex> guard(lock);
+        wakeup.notify_one();
+    }
+    notify_waiting();  //a waiting thread may execute the task too
+}
+
+bool ThreadPool::run_one(void){
+    function<void()>* task;
+    if(!queue.pop(task))
+        return false;
+    queued--;
+    (*task)();
+    delete task;
+    executed++;
+    notify_waiting();  //the task may have made a future ready
+    return true;
+}
+
+void ThreadPool::run(unsigned int number){
+    currentPool = this;
+    currentIndex = number;
+#ifdef __linux__
+    cpu_set_t allowed;  //the processors that the worker may run on (inherited from the thread that created the pool)
+    if(pin && pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed)==0 && number<(unsigned int)CPU_COUNT(&allowed)){
+        //the worker is pinned to the allowed processor with its number, and the extra workers are not pinned,
+        //so that they do not share a processor with a pinned one
+        int processor = -1;
+        for(unsigned int seen=0;seen<=number;)
+            if(CPU_ISSET(++processor, &allowed))
+                seen++;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(processor, &set);
+        if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set)==0)
+            pinned++;
+    }
+#endif
+
+    while(true){
+        if(run_one())
+            continue;
+        unique_lock<mutex> guard(lock);
+        sleeping++;
+        wakeup.wait(guard, [this]{ return stopping || queued.load()>0; });
+        sleeping--;
+        if(stopping && queued.load()==0)
+            return;
+    }
+}
@@ -0,0 +1,205 @@
+/**
+ * @file ThreadPoolImplementation.cpp
+ */
+#include "ThreadPoolImplementation.h"
+
+ThreadPoolImplementation::ThreadPoolImplementation(int argc, char* argv[]): WavefrontImplementation(argc, argv) {
+    bool pin = true;
+    threshold = 0;
+    for(int i=0;i<argc;i+=1){ //the threshold and the flag are optional
+        if(!string(argv[i]).compare("-no-pin"))
+            pin = false;
+        else if(i<argc-1 && !string(argv[i]).compare("-threshold")){
+            if(atoll(argv[i+1])<=0)
+                throw invalid_argument("Error. The threshold must be a positive integer.");
+            threshold = atoll(argv[i+1]);
+        }
+    }
+
+    usedThreshold = 0;
+    wavefrontPairs = 0;
+    singlePairs = 0;
+    wavefrontTime = 0;
+    singleTime = 0;
+    states.reset(new ThreadState[threads]);
+    for(size_t i=0;i<threads;i++){
+        states[i].tracker = OptimumTracker(algoScores.maxAlignments);
+        states[i].cells = 0;
+        states[i].steps = 0;
+        states[i].allocations = 0;
+        states[i].fillTime = 0;
+        states[i].tracebackTime = 0;
+    }
+    pool = new ThreadPool(threads-1, pin);  //the calling thread works too, while it waits for the tasks
+}
+
+ThreadPoolImplementation::~ThreadPoolImplementation(){
+    delete pool;
+}
+
+long long int ThreadPoolImplementation::fill_wavefront(const Pair& sequences, size_t index, ScoringMatrix& scoring_matrix, vector<Position>& max_pos_vec){
+    const long long int tile_rows = (sequences.q.size() + tile - 1)/tile;  //number of tiles in every column of the matrix
+    const long long int tile_cols = (sequences.d.size() + tile - 1)/tile;  //number of tiles in every row of the matrix
+
+    clear_borders(scoring_matrix);
+    for(size_t i=0;i<threads;i++){
+        states[i].tracker.reset();
+        states[i].tileCells = 0;
+    }
+
+    if(tile_rows>0 && tile_cols>0){
+        //a tile waits for the tile above it and the tile before it, and the last tile to finish completes the matrix
+        vector<atomic<int>> waiting(tile_rows*tile_cols);
+        for(long long int r=0;r<tile_rows;r++)
+            for(long long int c=0;c<tile_cols;c++)
+                waiting[r*tile_cols + c].store((r>0) + (c>0));
+        atomic<long long int> remaining(tile_rows*tile_cols);
+        promise<void> done;
+        future<void> finished = done.get_future();
+
+        function<void(long long int, long long int)> compute = [&](long long int r, long long int c){
+            ThreadState& state = states[pool->index()];
+            PhaseTimer timer(metrics, FILL_PHASE, index, r+c, r);
+            size_t row0 = r*tile + 1, col0 = c*tile + 1;
+            long long int cells = 0;  //counted locally, so that the threads do not write the same cache line for every cell
+            fill_tile(sequences, scoring_matrix, row0, col0, min(row0+tile-1, sequences.q.size()), min(col0+tile-1, sequences.d.size()),
+                      state.tracker, cells);
+            state.tileCells += cells;
+            timer.stop();
+
+            if(r+1<tile_rows && --waiting[(r+1)*tile_cols + c]==0)
+                pool->post([&compute, r, c]{ compute(r+1, c); });
+            if(c+1<tile_cols && --waiting[r*tile_cols + c+1]==0)
+                pool->post([&compute, r, c]{ compute(r, c+1); });
+            if(--remaining==0)
+                done.set_value();
+        };
+        pool->post([&compute]{ compute(0, 0); });
+        pool->wait(finished);
+    }
+
+    long long int cells = 0;
+    for(unsigned int i=1;i<threads;i++)
+        states[0].tracker.merge(states[i].tracker);
+    for(unsigned int i=0;i<threads;i++)
+        cells += states[i].tileCells;
+
+    //the tiles were computed in arbitrary order, so the cells are collected in row-major order like the other implementations
+    states[0].tracker.collect(max_pos_vec);
+    return cells;
+}
+
+void ThreadPoolImplementation::align_pair(size_t i){
+    ThreadState& state = states[pool->index()];
+    results[i].clear(); //for the case that this method is accidentally executed more than once
+    if(reuseResults(i)) //an identical pair has already been aligned
+        return;
+    PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+    state.matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+    allocate.stop();
+
+    long double time_f1 = getTime();
+    PhaseTimer fill(metrics, FILL_PHASE, firstPair + i);
+    state.cells += fill_sequential(data[i], state.matrix, state.max_pos);
+    fill.stop();
+    long double time_f2 = getTime();  //the clock is read once more for all the tracebacks of the pair, since they are usually short
+    state.fillTime += time_f2 - time_f1;
+    if(!keepPair(i, state.max_pos.empty() ? 0 : state.matrix[state.max_pos[0].row][state.max_pos[0].column]))
+        return;
+
+    PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+    state.steps += trace_pair(i, state.matrix, state.max_pos);
+    tracebacks.stop();
+    state.tracebackTime += getTime() - time_f2;
+    completeResults(i);
+    singlePairs++;
+}
+
+void ThreadPoolImplementation::printStatistics(void){
+    long double fillTime = 0, tracebackTime = 0;
+    for(size_t i=0;i<threads;i++){
+        fillTime += states[i].fillTime;
+        tracebackTime += states[i].tracebackTime;
+    }
+    cout << "A) Total pairs of sequences Q-D: " << totalPairs << endl;
+    cout << "B) Total cells with value: " << statisticData.cellsGreaterThanZero << endl;
+    cout << "C) Total traceback steps: " << statisticData.totalTracebackSteps << endl;
+    cout << "D) Total time of program execution: " << statisticData.totalTime << " seconds"<< endl;
+    cout << "E) Total time of calculating cells (summed over the threads of the pairs aligned by single threads): " << fillTime << " seconds" << endl;
+    cout << "F) Total traceback time (summed over the threads of the pairs aligned by single threads): " << tracebackTime << " seconds" << endl;
+    cout << "G) Cell Updates Per Second (CUPS) based on total execution time: " << (double)statisticData.cellUpdates/statisticData.totalTime << endl;
+    cout << "H) Cost threshold of the wavefront: " << usedThreshold << " cells" << (threshold>0 ? "" : " (tuned automatically)") << endl;
+    cout << "I) Pairs aligned as a wavefront by all the threads: " << wavefrontPairs << " in " << wavefrontTime << " seconds" << endl;
+    cout << "J) Pairs aligned by single threads: " << singlePairs << " in " << singleTime << " seconds" << endl;
+    cout << "K) Workers of the pool (pinned to a processor): " << pool->size() << " (" << pool->getPinnedWorkers() << ")" << endl;
+    cout << "L) Tasks executed by the pool: " << pool->getExecutedTasks() << endl;
+    cout << "M) Allocations of scoring matrices: " << statisticData.matrixAllocations << endl;
+    cout << "N) Tile size of the wavefront: " << tile << "x" << tile << " cells" << endl;
+    cout << "O) Pairs found in the cache (hits/misses): " << getCacheHits() << "/" << getCacheMisses() << endl;
+}
+
+void ThreadPoolImplementation::alignPairs(void){
+    long double time0 = getTime();
+
+    //the pairs from the most expensive to the cheapest, so that the single threads begin with the pairs that are hardest to balance
+    vector<size_t> order(data.size());
+    for(size_t i=0;i<data.size();i++)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b){
+        return (long long int)data[a].q.size()*data[a].d.size() > (long long int)data[b].q.size()*data[b].d.size();
+    });
+    usedThreshold = threshold>0 ? threshold : tune_threshold();
+    size_t split = 0;  //the pairs before it are aligned as a wavefront
+    while(split<order.size() && (long long int)(data[order[split]].q.size()*data[order[split]].d.size())>=usedThreshold)
+        split++;
+
+    ScoringMatrix scoring_matrix;  //reused for every pair of the wavefront
+    for(size_t k=0;k<split;k++){
+        size_t i = order[k];
+        vector<Position> max_pos_vec;
+        results[i].clear(); //for the case that this method is accidentally executed more than once
+        if(reuseResults(i)) //an identical pair has already been aligned
+            continue;
+        PhaseTimer allocate(metrics, ALLOCATE_PHASE);
+        scoring_matrix.reshape(data[i].q.size()+1, data[i].d.size()+1);
+        allocate.stop();
+
+        statisticData.cellsGreaterThanZero += fill_wavefront(data[i], firstPair + i, scoring_matrix, max_pos_vec);
+        if(!keepPair(i, max_pos_vec.empty() ? 0 : scoring_matrix[max_pos_vec[0].row][max_pos_vec[0].column]))
+            continue;
+
+        PhaseTimer tracebacks(metrics, TRACEBACK_PHASE, firstPair + i);
+        statisticData.totalTracebackSteps += trace_pair(i, scoring_matrix, max_pos_vec);
+        tracebacks.stop();
+        completeResults(i);
+        wavefrontPairs++;
+    }
+    statisticData.matrixAllocations += scoring_matrix.getAllocations();
+    long double time1 = getTime();
+    wavefrontTime += time1 - time0;
+
+    vector<future<void>> pending;
+    pending.reserve(order.size() - split);
+    for(size_t k=split;k<order.size();k++){
+        size_t i = order[k];
+        pending.push_back(pool->submit([this, i]{ align_pair(i); }));
+    }
+    for(size_t k=0;k<pending.size();k++){
+        pool->wait(pending[k]);
+        pending[k].get();  //throws the exception of the task, if any
+    }
+
+    long long int cells = 0, steps = 0;
+    for(size_t i=0;i<threads;i++){ //the tasks have finished, so the states can be read
+        cells += states[i].cells;
+        steps += states[i].steps;
+        states[i].cells = 0;
+        states[i].steps = 0;
+        statisticData.matrixAllocations += states[i].matrix.getAllocations() - states[i].allocations;
+        states[i].allocations = states[i].matrix.getAllocations();
+    }
+    statisticData.cellsGreaterThanZero += cells;
+    statisticData.totalTracebackSteps += steps;
+    singleTime += getTime() - time1;
+    statisticData.totalTime += getTime() - time0;
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+/**
+ * @file WavefrontImplementation.cpp
+ */
+#include "WavefrontImplementation.h"
+#include <omp.h>
+
+WavefrontImplementation::WavefrontImplementation(int argc, char* argv[]): Framework(argc, argv) {
+    int i;
+    tile = DEFAULT_TILE;
+    if(argc<=1){
+        cin.clear();
+        cout << "Please enter the number of threads for parallel execution:";
+        cin >> threads;
+    }
+    else{
+         for(i=0;i<argc-1;i+=1){
+            if(!string(argv[i]).compare("-threads")){
+                threads = atoi(argv[i+1]);
+                break;
+            }
+         }
+         if(i==argc-1)
+            throw invalid_argument("Error. Missing arguments.");
+
+         for(i=0;i<argc-1;i+=1){ //the tile size is optional
+            if(!string(argv[i]).compare("-tile")){
+                if(atoi(argv[i+1])<=0)
+                    throw invalid_argument("Error. The tile size must be a positive integer.");
+                tile = atoi(argv[i+1]);
+                break;
+            }
+         }
+    }
+    if((int)threads<=0)
+        throw invalid_argument("Error. The number of threads must be a positive integer.");
+
+    statisticData.calcCellsTime = new long double[1];
+    statisticData.totalTracebackTime = new long double[1];
+    statisticData.calcCellsTime[0] = 0;
+    statisticData.totalTracebackTime[0] = 0;
+}
+
+WavefrontImplementation::~WavefrontImplementation(){
+    delete statisticData.calcCellsTime;
+    delete statisticData.totalTracebackTime;
+}
+
+long long int WavefrontImplementation::tune_threshold(void){
+    long long int total = 0;
+    for(size_t i=0;i<data.size();i++)
+        total += (long long int)data[i].q.size()*data[i].d.size();
+    long long int side = (long long int)tile*threads;  //the rows (and columns) of a matrix with as many tiles per side as the threads
+    return max(total/threads + 1, side*side);
+}
+
+void WavefrontImplementation::clear_borders(ScoringMatrix& scoring_matrix){
+    for(size_t col=0;col<scoring_matrix.columns();col++)
+        scoring_matrix[0][col] = 0;
+    for(size_t row=0;row<scoring_matrix.size();row++)
+        scoring_matrix[row][0] = 0;
+}
+
+void WavefrontImplementation::fill_tile(const Pair& sequences, ScoringMatrix& scoring_matrix, size_t row0, size_t col0, size_t row1, size_t col1,
+                                        OptimumTracker& tracker, long long int& cells){
+    int n1, n2, n3;
+
+    for(size_t row=row0;row<=row1;row++){
+        const int* up = scoring_matrix[row-1];
+        int* current = scoring_matrix[row];
+        for(size_t col=col0;col<=col1;col++){
+            //compute the cell for match, mismatch and gap
+            if(sequences.q[row-1]==sequences.d[col-1])
+                n1 = up[col-1] + algoScores.matchScore;
+            else
+                n1 = up[col-1] + algoScores.mismatchScore;
+            n2 = up[col] + algoScores.gapScore;
+            n3 = current[col-1] + algoScores.gapScore;
+            current[col] = max(max(0, n1), max(n2, n3));
+
+            //How many cells have value>0
+            if(current[col]>0)
+                cells++;
+
+            //Search for the max value and save the Position x,y of max i matrix
+            tracker.update(current[col], row, col);
+        }
+    }
+}
+
+long long int WavefrontImplementation::fill_wavefront(const Pair& sequences, size_t index, ScoringMatrix& scoring_matrix, vector<Position>& max_pos_vec){
+    const long long int tile_rows = (sequences.q.size() + tile - 1)/tile;  //number of tiles in every column of the matrix
+    const long long int tile_cols = (sequences.d.size() + tile - 1)/tile;  //number of tiles in every row of the matrix
+    vector<OptimumTracker> trackers(threads, OptimumTracker(algoScores.maxAlignments));
+    vector<long long int> cell_vals(threads, 0);
+
+    clear_borders(scoring_matrix);
+    if(tile_rows>0 && tile_cols>0){
+        #pragma omp parallel num_threads(threads)
+        {
+            int thread = omp_get_thread_num();
+            long long int diag, t;
+
+            //the tiles of an anti-diagonal depend only on the tiles of the previous ones, so they are computed in parallel
+            for(diag=0;diag<tile_rows+tile_cols-1;diag++){
+                long long int first = diag<tile_cols ? 0 : diag-tile_cols+1;
+                long long int last = min(diag, tile_rows-1);
+
+                #pragma omp for schedule(dynamic)
+                for(t=first;t<=last;t++){
+                    PhaseTimer timer(metrics, FILL_PHASE, index, diag, t);  //every thread measures its own tiles (the waiting at the barriers is excluded)
+                    size_t row0 = t*tile + 1, col0 = (diag-t)*tile + 1;
+                    fill_tile(sequences, scoring_matrix, row0, col0, min(row0+tile-1, sequences.q.size()), min(col0+tile-1, sequences.d.size()),
+                              trackers[thread], cell_vals[thread]);
+                }
+            }
+        }
+    }
+
+    long long int cells = 0;
+    for(unsigned int i=1;i<threads;i++)
+        trackers[0].merge(trackers[i]);
+    for(unsigned int i=0;i<threads;i++)
+        cells += cell_vals[i];
+
+    //the tiles were computed in arbitrary order, so the cells are collected in row-major order like the other implementations
+    trackers[0].collect(max_pos_vec);
+    return cells;
+}
+
+long long int WavefrontImplementation::fill_sequential(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos_vec){
+    OptimumTracker tracker(algoScores.maxAlignments);
+    long long int cells = 0;
+
+    clear_borders(scoring_matrix);
+    //the whole matrix is a single tile, whose cells are visited in row-major order
+    if(sequences.q.size()>0 && sequences.d.size()>0)
+        fill_tile(sequences, scoring_matrix, 1, 1, sequences.q.size(), sequences.d.size(), tracker, cells);
+    tracker.collect(max_pos_vec);
+    return cells;
+}
+
+long long int WavefrontImplementation::trace_pair(size_t i, const ScoringMatrix& scoring_matrix, const vector<Position>& max_pos_vec){
+    Result res;
+    long long int steps = 0;
+
+    for(size_t j=0;j<max_pos_vec.size();j++){
+        res.ref_id = i;
+        res.score = scoring_matrix[max_pos_vec[j].row][max_pos_vec[j].column];
+        res.stop = max_pos_vec[j].column-1;
+        results[i].push_back(res);  //every pair is traced back by a single thread, so no locking is needed
+        steps += traceback(data[i], scoring_matrix, max_pos_vec[j].row, max_pos_vec[j].column, results[i].back());
+    }
+    return steps;
+}
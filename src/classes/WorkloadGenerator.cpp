@@ -0,0 +1,104 @@
+/**
+ * @file WorkloadGenerator.cpp
+ */
+#include "WorkloadGenerator.h"
+#include <fstream>
+#include <stdexcept>
+#include <math.h>
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadSettings& settings):
+    settings(settings), random(settings.seed) {
+    if(settings.alphabet.empty())
+        throw invalid_argument("Error. The alphabet of the workload is empty.");
+    if(settings.mutationRate<0 || settings.mutationRate>1 || settings.duplicateRatio<0 || settings.duplicateRatio>1)
+        throw invalid_argument("Error. The mutation rate and the duplicate ratio must be between 0 and 1.");
+    if(settings.lengthA<1 || (settings.distribution==UNIFORM_LENGTH && settings.lengthB<settings.lengthA) ||
+       (settings.distribution==LOG_NORMAL_LENGTH && settings.lengthB<0))
+        throw invalid_argument("Error. Invalid parameters of the length distribution.");
+}
+
+double WorkloadGenerator::uniform(void){
+    return (random()>>11)*(1.0/9007199254740992.0);  //the 53 bits of the mantissa
+}
+
+size_t WorkloadGenerator::below(size_t n){
+    return (size_t)(uniform()*n);
+}
+
+size_t WorkloadGenerator::next_length(void){
+    double length = settings.lengthA;
+    if(settings.distribution==UNIFORM_LENGTH)
+        length = settings.lengthA + below((size_t)settings.lengthB - (size_t)settings.lengthA + 1);
+    else if(settings.distribution==LOG_NORMAL_LENGTH){
+        double u1 = 1 - uniform(), u2 = uniform();  //Box-Muller transform (u1 is never 0)
+        double normal = sqrt(-2*log(u1))*cos(2*acos(-1.0)*u2);
+        length = round(settings.lengthA*exp(settings.lengthB*normal));
+    }
+    return length<1 ? 1 : (size_t)length;
+}
+
+string WorkloadGenerator::random_sequence(size_t length){
+    string sequence(length, 0);
+    for(size_t i=0;i<length;i++)
+        sequence[i] = settings.alphabet[below(settings.alphabet.size())];
+    return sequence;
+}
+
+string WorkloadGenerator::mutate(const string& q){
+    string d;
+    d.reserve(q.size() + q.size()/8);
+    for(size_t i=0;i<q.size();i++){
+        if(uniform()>=settings.mutationRate){
+            d += q[i];
+            continue;
+        }
+        double kind = uniform();
+        if(kind<0.5){ //substitution by a different symbol (if the alphabet has one)
+            char symbol = settings.alphabet[below(settings.alphabet.size())];
+            if(symbol==q[i] && settings.alphabet.size()>1)
+                symbol = settings.alphabet[(settings.alphabet.find(q[i]) + 1 + below(settings.alphabet.size()-1))%settings.alphabet.size()];
+            d += symbol;
+        }
+        else if(kind<0.75){ //insertion of a random symbol before the symbol of Q
+            d += settings.alphabet[below(settings.alphabet.size())];
+            d += q[i];
+        }
+        //otherwise a deletion, i.e. the symbol of Q is skipped
+    }
+    if(d.empty()) //the input files cannot have empty sequences
+        d = random_sequence(1);
+    return d;
+}
+
+void WorkloadGenerator::write(ostream& output){
+    vector<string> recent;  //the most recent distinct pairs, in a circular buffer, so that duplicates copy one of them
+    size_t oldest = 0;
+
+    for(size_t p=0;p<settings.pairs;p++){
+        if(!recent.empty() && uniform()<settings.duplicateRatio){
+            output << recent[below(recent.size())];
+            continue;
+        }
+        string q = random_sequence(next_length());
+        string pair = "Q: " + q + "\nD: " + mutate(q) + "\n";
+        output << pair;
+        if(settings.duplicateRatio>0){ //the distinct pairs are kept only if they may be duplicated
+            if(recent.size()<DUPLICATE_WINDOW)
+                recent.push_back(move(pair));
+            else{
+                recent[oldest] = move(pair);
+                oldest = (oldest + 1)%DUPLICATE_WINDOW;
+            }
+        }
+    }
+}
+
+void WorkloadGenerator::write(const string& path){
+    ofstream output(path.c_str());
+    if(!output.is_open())
+        throw ios_base::failure((string("Output file ") + path + string(" cannot be opened.")).c_str());
+    write(output);
+    output.close();
+    if(output.fail())
+        throw ios_base::failure((string("Output file ") + path + string(" cannot be written.")).c_str());
+}
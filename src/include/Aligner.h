@@ -0,0 +1,104 @@
+/**
+ * @file Aligner.h
+ */
+#pragma once
+
+#include "Framework.h"
+
+using namespace std;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a sequential execution of the algorithm.*/
+const int SEQUENTIAL_IMPL = 1;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a coarse-level parallel execution of the algorithm.*/
+const int PARALLEL_COARSE_IMPL = 2;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a fine-level parallel execution of the algorithm.*/
+const int PARALLEL_FINE_IMPL = 3;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a sequential execution of the algorithm with the striped SIMD kernel.*/
+const int SIMD_STRIPED_IMPL = 4;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a sequential execution of the algorithm in linear space.*/
+const int LINEAR_SPACE_IMPL = 5;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a sequential execution of the algorithm with the inter-sequence SIMD kernel.*/
+const int SIMD_BATCH_IMPL = 6;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a sequential execution of the algorithm with the bit-parallel kernel.*/
+const int BIT_PARALLEL_IMPL = 7;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a parallel execution of the algorithm which mixes the coarse and the fine level.*/
+const int PARALLEL_HYBRID_IMPL = 8;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a parallel execution of the algorithm with a pool of persistent threads (without OpenMP).*/
+const int THREAD_POOL_IMPL = 9;
+
+/** The integer value of this constant is the value of the input argument '-parallel' that determines a sequential execution of the algorithm inside a band of diagonals.*/
+const int BANDED_IMPL = 10;
+
+/**
+ * The entry point of the library (libsmithwaterman), which aligns pairs of sequences held in the memory of the calling program
+ * with the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>, without any
+ * input file or report. It is configured once with the scores, the version of the algorithm and the threads, so the threads
+ * and the scoring matrices of the version are reused by all the batches of pairs. Identical pairs are aligned only once
+ * during the lifetime of an instance. An instance must not be used by multiple threads at the same time.
+ * @author Georgios Apostolakis
+ */
+class Aligner {
+    public:
+        /**
+         * Constructs a new instance of this class.
+         * @param scores The match, mismatch and gap scores of the algorithm, and the limits of the alignments of every pair.
+         * @param engine The version of the algorithm, i.e. one of the values of the '-parallel' argument (e.g. {@link #SEQUENTIAL_IMPL}).
+         * @param threads The number of threads of the parallel versions (it is ignored by the sequential ones).
+         * @throws std::invalid_argument Thrown if the version does not exist or the number of threads is not positive.
+         * @throws std::system_error Thrown if the threads cannot be created.
+         */
+        Aligner(const Scores& scores, int engine, unsigned int threads);
+
+        /**
+         * Destroys an instance of the current class and stops its threads.
+         */
+        ~Aligner(void);
+
+        /**
+         * Aligns a batch of pairs and provides all their alignments.
+         * @param pairs An array with the pairs of sequences.
+         * @param count The number of pairs of the array.
+         * @param results A vector that is replaced with the alignments of every pair, in the order of the array.
+         */
+        void align(const SequencePair* pairs, size_t count, vector<vector<Result>>& results);
+
+        /**
+         * Aligns a batch of pairs and hands the alignments of every pair to a callback as soon as they are found
+         * (see Framework#alignBatch()), so that they do not have to be kept until the whole batch is aligned.
+         * @param pairs An array with the pairs of sequences.
+         * @param count The number of pairs of the array.
+         * @param callback A function that is called once for every pair, with the index of the pair in the array and its alignments.
+         * In the parallel versions it is called by multiple threads at the same time, and it must not throw any exception.
+         */
+        void align(const SequencePair* pairs, size_t count, const function<void(size_t, vector<Result>&)>& callback);
+
+        /**
+         * Provides the statistical data of all the batches that have been aligned so far.
+         * @return A {@link Statistics} object, whose times are filled in by the version of the algorithm.
+         */
+        const Statistics& getStatistics(void) const;
+
+        /**
+         * Constructs a version of the algorithm (see the Framework() constructor and the constructors of the versions).
+         * @param engine The version of the algorithm, i.e. one of the values of the '-parallel' argument.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv The arguments of the version.
+         * @return A new object of the version, which is owned by the caller, or null if the version does not exist.
+         */
+        static Framework* createEngine(int engine, int argc, char* argv[]);
+
+    private:
+        /** The version of the algorithm, constructed with the {@code -memory} argument. */
+        Framework* engine;
+
+        Aligner(const Aligner&) = delete;
+        Aligner& operator=(const Aligner&) = delete;
+};
\ No newline at end of file
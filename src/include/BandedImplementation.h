@@ -0,0 +1,185 @@
+/**
+ * @file BandedImplementation.h
+ */
+#pragma once
+
+#include "Framework.h"
+
+using namespace std;
+
+/**
+* The cells of a scoring matrix that lie in a band of diagonals (a diagonal is the column of a cell minus its row).
+* Every row stores the same number of cells, one for every diagonal of the band, plus a zero cell at each side,
+* so the neighbours of a cell are found at fixed offsets and the cells outside of the band are read as zero.
+* @author Georgios Apostolakis
+*/
+struct BandMatrix {
+    /** The cells of the band, row by row. */
+    vector<int> cells;
+
+    /** The lowest diagonal of the band. */
+    int low;
+
+    /** The highest diagonal of the band. */
+    int high;
+
+    /** The number of cells of every row in the {@link #cells} (the diagonals of the band and the 2 zero cells). */
+    size_t stride;
+
+    /** The number of times that memory was allocated for the {@link #cells}. */
+    long long int allocations;
+
+    /**
+     * Resizes the band for a scoring matrix, reusing the memory of the previous one if it is large enough. All the cells become zero.
+     * @param rows The number of rows of the scoring matrix.
+     * @param low The lowest diagonal of the band.
+     * @param high The highest diagonal of the band.
+     */
+    void reshape(size_t rows, int low, int high){
+        this->low = low;
+        this->high = high;
+        stride = high - low + 3;
+        if(rows*stride>cells.capacity())
+            allocations++;
+        cells.assign(rows*stride, 0);
+    }
+
+    /**
+     * Provides a row of the band.
+     * @param row The row of the scoring matrix.
+     * @return A pointer to the cell of the row at the lowest diagonal (the zero cell before it is at index -1).
+     */
+    int* operator[](size_t row){
+        return &cells[row*stride + 1];
+    }
+
+    /**
+     * Provides the value of a cell of the scoring matrix.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return An integer with the value of the cell (zero if the cell is outside of the band).
+     */
+    int operator()(unsigned int row, unsigned int col) const {
+        int diagonal = (int)col - (int)row;
+        if(diagonal<low || diagonal>high)
+            return 0;
+        return cells[row*stride + 1 + diagonal - low];
+    }
+};
+
+/**
+ * This class extends the {@link Framework} class and implements the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+ * in a sequential manner (1 thread), computing and storing only a band of diagonals of every scoring matrix, so that the time and
+ * the memory of similar sequences grow linearly to their size. The band is centered on the diagonal where most of the short
+ * identical substrings (seeds) of the 2 sequences lie, or on the main diagonal if they have none in common. The cells outside of the
+ * band are treated as zero, so the alignments are found inside the band, and they are identical to those of the other
+ * implementations when the band contains them. It is a heuristic: an optimal alignment that lies wholly outside of the band
+ * never touches its edge, so it is neither detected nor found by a wider band, and the pair is reported with the best
+ * alignments inside the band (whose score may be lower than the one of the other implementations).
+ * @author Georgios Apostolakis
+ */
+class BandedImplementation : public Framework {
+    public:
+        /**
+         * Calls the Framework() constructor of the parent class. If no arguments are provided by the user,
+         * it asks for them through console questions.
+         * The valid arguments are the same with the arguments listed in the documentation of the Framework() constructor, plus:
+         * - {@code -band <integer with the number of diagonals at each side of the central one>} (optional, adaptive by default)<br>
+         * Any extra (and possibly invalid) arguments are ignored without throwing any exception.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing, or the band is negative.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         */
+        BandedImplementation(int argc, char* argv[]);
+
+        /**
+         * Destroys an instance of the current class by calling the ~Framework() destructor
+         * of the parent class.
+         */
+        virtual ~BandedImplementation();
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * in a sequential way (1 thread), inside a band of every scoring matrix. With a fixed band, it warns about the pairs whose
+         * alignments touch the edge of the band (since a wider band might find better ones). With an adaptive band, the band of
+         * such a pair is doubled until its alignments no longer touch the edge (or the band contains the whole matrix).
+         * Only the cells of the bands are counted in the {@link Statistics#cellUpdates}.
+         */
+        void alignPairs(void) final;
+
+        /**
+         * Prints some statistics into console about the execution details of the algorithm.
+         */
+        void printStatistics(void) final;
+
+    private:
+        /** The number of diagonals at each side of the central one, with which the adaptive band begins. */
+        static const int DEFAULT_BAND = 16;
+
+        /** The length of the seeds, i.e. of the identical substrings that determine the central diagonal of the band. */
+        static const unsigned int SEED_LENGTH = 8;
+
+        /** The number of diagonals at each side of the central one, as given by the user (negative if the band is adaptive). */
+        int band;
+
+        /** The band of the scoring matrix, which is reused for every pair. */
+        BandMatrix band_matrix;
+
+        /** The number of cells that were computed inside the bands (for the statistics). */
+        long long int bandCells;
+
+        /** The number of cells of the whole scoring matrices of the pairs whose bands were computed (for the statistics). */
+        long long int matrixCells;
+
+        /** The number of cells that were computed inside the bands of the current pair (including the bands before a widening). */
+        long long int pairBandCells;
+
+        /** The number of times that the band of a pair was doubled (for the statistics). */
+        long long int widenings;
+
+        /** The number of pairs whose alignments touch the edge of a fixed band (for the statistics). */
+        long long int edgePairs;
+
+        /** The widest band that was used, in diagonals (for the statistics). */
+        int widestBand;
+
+        /**
+         * Finds the diagonal where the band of a pair is centered: every substring of length {@link #SEED_LENGTH} of the D
+         * sequence that also appears in the Q sequence votes for the diagonal between the two, and the diagonal with the most votes wins
+         * (the diagonal that is closer to the main one breaks ties).
+         * @param sequences A {@link Pair} object with the sequences.
+         * @return An integer with the central diagonal (0 if the sequences have no seeds in common).
+         */
+        int seed_diagonal(const Pair& sequences);
+
+        /**
+         * Provides the number of cells that were computed inside the bands of the current pair (see Framework#pairCells()).
+         * @param i The index of the input pair in the {@link #data} vector.
+         * @return A long long integer with the cells of the bands of the pair.
+         */
+        long long int pairCells(size_t i) final;
+
+        /**
+         * Fills the cells of a band of the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> sequentially.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param band_matrix The {@link BandMatrix} object, whose cells will be filled (its band must have been set).
+         * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value
+         * (only the cells whose value is greater than zero).
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_band(const Pair& sequences, BandMatrix& band_matrix, vector<Position>& max_pos);
+
+        /**
+         * Checks whether an alignment passes through a cell at the lowest or the highest diagonal of the band
+         * (unless that diagonal is the last one of the scoring matrix, where the band does not cut any cells).
+         * @param sequences A {@link Pair} object with the aligned sequences.
+         * @param result The {@link Result} object with the alignment.
+         * @param end The cell where the traceback of the alignment began.
+         * @return True if the alignment touches the edge of the band, otherwise false.
+         */
+        bool touches_edge(const Pair& sequences, const Result& result, Position end);
+};
\ No newline at end of file
@@ -0,0 +1,116 @@
+/**
+ * @file BatchReader.h
+ */
+#pragma once
+
+#include "Framework.h"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <condition_variable>
+
+using namespace std;
+
+/**
+* A batch of consecutive pairs of an input file, together with the memory of their sequences.
+* @author Georgios Apostolakis
+*/
+struct PairBatch {
+    /** The index of the first pair of the batch in the input file. */
+    size_t first;
+
+    /** The packed sequences of the batch, where the {@link #pairs} point to (every batch has its own alphabet). */
+    SequenceStore store;
+
+    /** The pairs of the batch. */
+    vector<Pair> pairs;
+};
+
+/**
+ * Reads an input file with pairs of sequences in the background, as a stream of {@link PairBatch} objects.
+ * A reader thread parses the file while the previous batches are aligned, but it stops when {@link #MAX_QUEUED}
+ * batches wait to be aligned, so only a few batches are in memory no matter how large the file is.
+ * @author Georgios Apostolakis
+ */
+class BatchReader {
+    public:
+        /** The number of parsed batches above which the reader thread waits for them to be taken. */
+        static const size_t MAX_QUEUED = 2;
+
+        /** The size of the buffer of the input file in bytes. */
+        static const size_t BUFFER_SIZE = 1<<20;
+
+        /**
+         * Opens the input file and starts the reader thread.
+         * @param path The path of the input file.
+         * @param batchSize The number of pairs of every batch (the last one may have fewer).
+         * @param metrics The {@link Metrics} where the reader thread measures the time of parsing (or null).
+         * @throws std::ios_base::failure Thrown if the input file cannot be opened.
+         */
+        BatchReader(const string& path, size_t batchSize, Metrics* metrics);
+
+        /**
+         * Stops the reader thread, releases the batches that were not taken and closes the input file.
+         */
+        ~BatchReader(void);
+
+        /**
+         * Takes the next batch of the file, waiting until the reader thread has parsed it.
+         * @return A {@link PairBatch} object (which has to be deleted by the caller), or null at the end of the file.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid (after the batches that precede the error).
+         */
+        PairBatch* next(void);
+
+    private:
+        /** The input file. */
+        ifstream input;
+
+        /** The buffer of the {@link #input} stream. */
+        vector<char> buffer;
+
+        /** The number of pairs of every batch. */
+        size_t batchSize;
+
+        /** Where the reader thread measures the time of parsing (null if nothing is measured). */
+        Metrics* metrics;
+
+        /** The batches that have been parsed but not taken yet. */
+        deque<PairBatch*> queue;
+
+        /** True when the reader thread has parsed the whole file (or found invalid contents). */
+        bool finished;
+
+        /** True when the reader thread has to stop, because the batches are no longer needed. */
+        bool stopping;
+
+        /** The error that stopped the reader thread (null if there was none). */
+        exception_ptr error;
+
+        /** A lock that protects the {@link #queue}, {@link #finished}, {@link #stopping} and {@link #error}. */
+        mutex lock;
+
+        /** Signals the consumer that a batch was parsed (or that the reader thread finished). */
+        condition_variable parsed;
+
+        /** Signals the reader thread that a batch was taken (or that it has to stop). */
+        condition_variable taken;
+
+        /** The reader thread. */
+        thread worker;
+
+        /**
+         * The body of the reader thread, which parses the file batch by batch.
+         */
+        void run(void);
+
+        /**
+         * Appends a batch to the {@link #queue}, waiting while the queue is full.
+         * @param batch The {@link PairBatch} object.
+         * @return False if the reader thread has to stop (the batch is deleted), otherwise true.
+         */
+        bool push(PairBatch* batch);
+
+        BatchReader(const BatchReader&) = delete;
+        BatchReader& operator=(const BatchReader&) = delete;
+};
@@ -0,0 +1,160 @@
+/**
+ * @file BitParallelImplementation.h
+ */
+#pragma once
+
+#include "Framework.h"
+#include <stdint.h>
+
+using namespace std;
+
+/**
+* A scoring matrix which is stored with a single bit for every cell, as computed by the bit-parallel kernel.
+* When the gap score is zero, the mismatch score is not positive and the match score is positive, the value of cell {@code (i, j)}
+* is the match score multiplied by the length of the
+* <a href="https://en.wikipedia.org/wiki/Longest_common_subsequence">longest common subsequence</a> (LCS) of the first i symbols
+* of Q and the first j symbols of D. Bit {@code i-1} of column j is zero where the LCS grows from row i-1 to row i, so the value
+* of a cell is found by counting the zeros of the column up to its row. The zeros before every word are counted in advance,
+* so that a cell is provided in constant time.
+* @author Georgios Apostolakis
+*/
+struct BitScoringMatrix {
+    /** The number of rows of the matrix (i.e. the size of the Q sequence plus 1). */
+    unsigned int rows;
+
+    /** The number of columns of the matrix (i.e. the size of the D sequence plus 1). */
+    unsigned int columns;
+
+    /** The number of 64-bit words of every column. */
+    unsigned int words;
+
+    /** The score of a match, which multiplies the length of the LCS. */
+    int matchScore;
+
+    /** The memory where the bits and the counts are stored (reused for every pair). */
+    MatrixArena arena;
+
+    /** The bits of the matrix, column after column (column 0 included). */
+    uint64_t* bits;
+
+    /** For every word of {@link #bits}, the number of zeros in the previous words of the same column. */
+    uint32_t* counts;
+
+    /**
+     * Provides the value of a cell of the matrix.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return An integer with the value of the cell.
+     */
+    int operator()(unsigned int row, unsigned int col) const {
+        if(row==0)
+            return 0;
+        size_t word = (size_t)col*words + (row-1)/64;
+        uint64_t below = ~0ULL>>(63 - (row-1)%64);  //the bits of the rows up to the requested one
+        return matchScore*(int)(counts[word] + __builtin_popcountll(~bits[word] & below));
+    }
+};
+
+/**
+ * This class extends the {@link Framework} class and implements the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+ * with a bit-parallel kernel (1 thread). When the gap score is zero, the mismatch score is not positive and the match score is
+ * positive, the scoring matrix is the match score multiplied by the table of the
+ * <a href="https://en.wikipedia.org/wiki/Longest_common_subsequence">longest common subsequence</a>, which is computed 64 rows at a
+ * time with the bit-vector recurrence of <a href="https://doi.org/10.1016/0020-0190(86)90091-8">Allison and Dix</a>
+ * (the match masks of the Q symbols are built once for consecutive pairs with the same Q). Every other pair is computed with the ordinary
+ * (scalar) process.
+ * @author Georgios Apostolakis
+ */
+class BitParallelImplementation : public Framework {
+    public:
+        /**
+         * Calls the Framework() constructor of the parent class. If no arguments are provided by the user,
+         * it asks for them through console questions. The valid arguments are
+         * the same with those listed in the documentation of the Framework() constructor. Any
+         * extra (and possibly invalid) arguments are ignored without throwing any exception. It warns the user if the scores
+         * do not suit the bit-parallel kernel, since then no pair can use it.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         */
+        BitParallelImplementation(int argc, char* argv[]);
+
+        /**
+         * Destroys an instance of the current class by calling the ~Framework() destructor
+         * of the parent class.
+         */
+        virtual ~BitParallelImplementation();
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with the bit-parallel kernel (1 thread).
+         */
+        void alignPairs(void) final;
+
+        /**
+         * Prints some statistics into console about the execution details of the algorithm.
+         */
+        void printStatistics(void) final;
+
+    private:
+        /** The match masks of the Q sequence, i.e. for every symbol a bit-vector whose bit i is set where Q has the symbol at row i+1. */
+        vector<uint64_t> masks;
+
+        /** The index of every symbol in the {@link #masks} (or -1 if the symbol does not appear in the Q sequence). */
+        int maskIndex[256];
+
+        /** A bit-vector without any set bit, which is the mask of the symbols that do not appear in the Q sequence. */
+        vector<uint64_t> noMatches;
+
+        /** The Q sequence of the {@link #masks}. */
+        string maskQuery;
+
+        /** The number of times that the {@link #masks} were built for a new Q sequence. */
+        long long int maskSets;
+
+        /** The number of pairs that were computed with the scalar process instead of the bit-parallel kernel. */
+        long long int scalarPairs;
+
+        /**
+         * Fills the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with the bit-parallel kernel. It must be used only for the scores that the kernel supports (see #bit_parallel_scores()).
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix A {@link BitScoringMatrix} object, whose bits will be filled according to the process
+         * defined by the algorithm.
+         * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value
+         * (in row-major order).
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_scoring_matrix(const Pair& sequences, BitScoringMatrix& scoring_matrix, vector<Position>& max_pos);
+
+        /**
+         * Fills the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> sequentially,
+         * one cell at a time. It is used for the pairs that the bit-parallel kernel cannot handle.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm. Every cell will contain an integer value.
+         * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_scoring_matrix_scalar(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos);
+
+        /**
+         * Decides whether a pair can be computed by the bit-parallel kernel, i.e. whether the scores reduce the algorithm
+         * to the longest common subsequence and the largest possible score fits in an integer.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @return True if the pair can be computed by the bit-parallel kernel, otherwise false.
+         */
+        bool bit_parallel_scores(const Pair& sequences);
+
+        /**
+         * Builds the match masks of a Q sequence into the {@link #masks}, unless they were built for the same Q sequence.
+         * @param q The Q sequence.
+         * @param words The number of 64-bit words of every mask.
+         */
+        void build_masks(const PackedSequence& q, unsigned int words);
+};
@@ -10,20 +10,57 @@
 #include <fstream>
 #include <vector>
 #include <stdexcept>
-#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string_view>
+#include "ScoringMatrix.h"
+#include "PackedSequence.h"
+#include "Metrics.h"
 
 using namespace std;
 
+class ResultCache;
+class ReportWriter;
+class BatchReader;
+struct PairBatch;
+
 /**
 * A pair of 2 sequences named Q and D, which have to be aligned
 * (by the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>).
+* The sequences are packed (see {@link PackedSequence}) into the memory of a {@link SequenceStore}.
 * @author Georgios Apostolakis
 */
 struct Pair {
-    /** A string with the Q sequence. */
+    /** The Q sequence. */
+    PackedSequence q;
+
+    /** The D sequence. */
+    PackedSequence d;
+};
+
+/**
+* A pair of 2 sequences named Q and D, as they are given by a program that aligns them in memory (see Framework#alignBatch()).
+* The symbols are not copied, so they must remain valid until they are aligned.
+* @author Georgios Apostolakis
+*/
+struct SequencePair {
+    /** The Q sequence. */
+    string_view q;
+
+    /** The D sequence. */
+    string_view d;
+};
+
+/**
+* A pair of 2 aligned sequences (with gaps), as produced by the traceback process.
+* @author Georgios Apostolakis
+*/
+struct AlignedPair {
+    /** A string with the aligned Q sequence. */
     string q;
 
-    /** A string with the D sequence. */
+    /** A string with the aligned D sequence. */
     string d;
 };
 
@@ -56,8 +93,8 @@ struct Result {
     /** An integer with the stopping index. */
     int stop;
 
-    /** A {@link #Pair} object with the aligned sequences. */
-    Pair result_pair;
+    /** An {@link #AlignedPair} object with the aligned sequences. */
+    AlignedPair result_pair;
 };
 
 /**
@@ -73,6 +110,12 @@ struct Scores {
 
     /** The score of a gap between the sequences. */
     int gapScore;
+
+    /** The maximum number of alignments of every pair, i.e. of the first cells with the maximum value in row-major order (0 for all of them). */
+    unsigned int maxAlignments;
+
+    /** True if the identical alignments of a pair (e.g. those found from different rows of a repetitive Q sequence) are reported once. */
+    bool collapseAlignments;
 };
 
 /**
@@ -83,6 +126,12 @@ struct Statistics {
     /** The cells at the scoring matrix with a value greater than zero. */
     long long int cellsGreaterThanZero;
 
+    /**
+     * The cells of the scoring matrices that were computed, i.e. the sum of |Q|*|D| over the aligned pairs (the pairs found in
+     * the cache are not computed, and the banded version counts only the cells of its bands). It is updated by the threads of the parallel versions concurrently.
+     */
+    atomic<long long int> cellUpdates;
+
     /** The total traceback steps executed by the algorithm. */
     long long int totalTracebackSteps;
 
@@ -94,6 +143,9 @@ struct Statistics {
 
     /** The total time that the traceback process lasted (in seconds). */
     long double *totalTracebackTime;
+
+    /** The number of times that memory was allocated for the scoring matrices. */
+    long long int matrixAllocations;
 };
 
 /**
@@ -107,19 +159,32 @@ class Framework {
         /**
          * Constructs a new instance of this class. If no arguments are provided by the user,
          * it asks for them through console questions. Then, it reads the sequences to be aligned
-         * from an input file.<br>
+         * from an input file (or, in a pipelined execution, it starts reading them in the background).<br>
          * Valid arguments:
          * - {@code -id <string with the id of the report>}
          * - {@code -path <string with the input file's path>}
          * - {@code -match <integer with the match score>}
          * - {@code -mismatch <integer with the mismatch score>}
-         * - {@code -gap <integer with the gap score>}<br>
+         * - {@code -gap <integer with the gap score>}
+         * - {@code -cache <string with the path of a cache file>} (optional)
+         * - {@code -cache-size <integer with the maximum number of pairs in the cache>} (optional, 0 disables the cache)
+         * - {@code -batch <integer with the number of pairs of every batch>} (optional, for a pipelined execution)
+         * - {@code -min-score <integer with the lowest score of the pairs that are aligned>} (optional)
+         * - {@code -top-k <integer with the number of best pairs that are aligned>} (optional, it cannot be pipelined)
+         * - {@code -max-alignments <integer with the maximum number of alignments of every pair>} (optional, all of them by default)
+         * - {@code -collapse-alignments} (optional, the identical alignments of a pair are reported once)<br>
+         * Instead of {@code -path}, a database search may be requested with the arguments:
+         * - {@code -query <string with the path of a file with the Q sequence>}
+         * - {@code -db <string with the path of a file with the D sequences>}
+         * - {@code -top <integer with the number of best D sequences to report>} (optional)<br>
+         * Instead of an input file, the pairs may be given in memory (see #alignBatch()) with the argument {@code -memory},
+         * in which case only the scores are required and no report is written.<br>
          * Notice that any extra (and possibly invalid) arguments are ignored without throwing any exception.
          * @param argc An integer with the size of the {@code argv} argument.
          * @param argv An array with the arguments provided by the user.
          * @throws std::ios_base::failure Thrown if the input file cannot be opened.
-         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing.
-         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing or invalid.
+         * @throws std::runtime_error Thrown if the contents of the input file (or the cache file) are invalid.
          */
         Framework(int argc, char* argv[]);
 
@@ -130,23 +195,74 @@ class Framework {
 
         /**
          * Saves the aligned sequences into file '/reports/Report_ID.txt',
-         * where ID was given by the user (either as an argument, or through console).
+         * where ID was given by the user (either as an argument, or through console). If the pairs are given in memory, it does nothing.
          * The data to save is retrieved from the {@link Framework#results results} member-variable of this class.
+         * Usually the pairs have already been handed over to the {@link #writer} while they were aligned, so it only
+         * waits until they are written. In a database search the pairs are ranked by their score (the input order breaks ties),
+         * and only the best {@link #topResults} of them are saved.
          * @throws std::ios_base::failure Thrown if the output file cannot be opened.
          */
         void printResultsToFile(void);
 
+        /**
+         * Saves the alignments of the {@link #cache} into the file given by the user with the {@code -cache}
+         * argument, so that they can be reused by a later execution. If no such file was given, it does nothing.
+         * @throws std::ios_base::failure Thrown if the cache file cannot be opened.
+         */
+        void saveCache(void);
+
+        /**
+         * Saves the measurements of the {@link #metrics} (together with a summary of the {@link #statisticData}) into the JSON file
+         * given by the user with the {@code -metrics} argument, and the timeline of the threads into the trace file given with the
+         * {@code -trace} argument. If no such files were given, it does nothing.
+         * @throws std::ios_base::failure Thrown if the metrics file or the trace file cannot be written.
+         */
+        void saveMetrics(void);
+
         /**
          * An abstract method that prints some statistics into console about the execution details of the algorithm.
          */
         virtual void printStatistics(void) = 0;
 
         /**
-         * This abstract method executes the
-         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
-         * and has to be implemented in all descendant classes.
+         * Provides the statistical data of the execution, e.g. to compare the versions of the algorithm without parsing their console output.
+         * @return A {@link Statistics} object, whose times are filled in by the version of the algorithm that was executed.
+         */
+        const Statistics& getStatistics(void) const;
+
+        /**
+         * Provides the number of input pairs whose alignments were found in the {@link #cache}.
+         * @return A long long integer with the number of hits.
          */
-        virtual void runAlgorithm(void) = 0;
+        long long int getCacheHits(void) const;
+
+        /**
+         * Provides the number of input pairs whose alignments were not found in the {@link #cache}.
+         * @return A long long integer with the number of misses.
+         */
+        long long int getCacheMisses(void) const;
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * for all the input pairs (see #alignPairs()). In a pipelined execution the pairs are aligned batch by batch: the next batches
+         * are read and the previous one is written in the background while a batch is aligned, and at most a few batches are kept in memory.
+         * @throws std::runtime_error Thrown in a pipelined execution if the contents of the input file are invalid (the pairs that precede
+         * the invalid contents may have been aligned already).
+         */
+        void runAlgorithm(void);
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * for a batch of pairs that are given in memory (see #alignPairs()). The alignments of every pair are handed to a consumer
+         * as soon as they are found, instead of being written into the report. The statistics of successive calls are accumulated.
+         * @param pairs An array with the pairs of sequences (it is not needed after the method returns).
+         * @param count The number of pairs of the array.
+         * @param consumer A function that is called once for every pair, with the index of the pair in the array and its alignments
+         * (which the consumer may move away). In the parallel versions it is called by multiple threads at the same time, and it must not
+         * throw any exception.
+         * @throws std::logic_error Thrown if the instance was not constructed with the {@code -memory} argument.
+         */
+        void alignBatch(const SequencePair* pairs, size_t count, const function<void(size_t, vector<Result>&)>& consumer);
 
     protected:
         /** Contains the match, mismatch, gap scores on which depends the output of the algorithm. */
@@ -158,6 +274,64 @@ class Framework {
         /** The path of the file that contains the input data, i.e. the sequences that need alignment. */
         string path;
 
+        /** The path of the file with the Q sequence of a database search (empty if the input is given as pairs). */
+        string queryPath;
+
+        /** The path of the file with the D sequences (database) of a database search. */
+        string databasePath;
+
+        /** The number of best D sequences that are reported by a database search (0 for all of them). */
+        size_t topResults;
+
+        /** True if the pairs are given in memory through #alignBatch() instead of an input file. */
+        bool inMemory;
+
+        /** The consumer of the alignments of the batch that #alignBatch() aligns (otherwise null). */
+        const function<void(size_t, vector<Result>&)>* consumer;
+
+        /** The number of pairs of every batch in a pipelined execution (0 if the whole input is read at once). */
+        size_t batchSize;
+
+        /**
+         * The index of the first pair of the {@link #data} in the report, i.e. among the pairs that passed the {@link #topK} filter
+         * (non-zero only in a pipelined execution or when the pairs are given in memory).
+         */
+        size_t firstPair;
+
+        /** The number of input pairs that have been read (so far, in a pipelined execution). */
+        size_t totalPairs;
+
+        /** The number of pairs before the {@link #data} that passed the {@link #topK} filter (see #filterPairs()). */
+        size_t selectedPairs;
+
+        /** The score below which a pair is not traced back nor reported (0 if the pairs are not filtered by their score). */
+        int minScore;
+
+        /** The number of best pairs (by their score) that are aligned, while the rest are not (0 for all of them). */
+        size_t topK;
+
+        /** The index of every pair of the {@link #data} before the filters were applied (empty if no pair was filtered out). */
+        vector<size_t> selection;
+
+        /** True while the pairs are scored for the {@link #topK} filter, i.e. #alignPairs() only fills their scoring matrices. */
+        bool scoring;
+
+        /** The score of every pair of the {@link #data}, while they are scored for the {@link #topK} filter. */
+        vector<int> scores;
+
+        /**
+         * The variant of the alignments of the version, which is part of the keys of the {@link #cache}. It is empty for the versions
+         * that find the exact optimal alignments, and set by the versions whose alignments may differ from them (e.g. inside a band),
+         * so that the alignments of one are never reused by the other.
+         */
+        string variant;
+
+        /** The number of pairs that were filtered out, i.e. neither traced back nor reported. It is updated by multiple threads. */
+        atomic<long long int> filteredPairs;
+
+        /** The packed symbols of the input sequences, where the {@link #data} point to (unless the execution is pipelined). */
+        SequenceStore sequenceStore;
+
         /**
          * A string with the ID of the report produced after the execution of the
          * algorithm. The ID is part of the report's filename.
@@ -170,14 +344,162 @@ class Framework {
         /** Contains statistical data about the execution of the algorithm. */
         Statistics statisticData;
 
+        /** The alignments of the pairs that have already been aligned, so that identical pairs are aligned only once. */
+        ResultCache* cache;
+
+        /** The path of the file where the {@link #cache} is saved (empty if the cache is not saved). */
+        string cachePath;
+
+        /** The maximum number of entries of the {@link #cache} (0 if it is disabled). */
+        size_t cacheSize;
+
+        /** The maximum number of entries of the {@link #cache}, if it is not given by the user. */
+        static const size_t DEFAULT_CACHE_SIZE = 1<<16;
+
+        /** Measures the phases of the execution per thread (null if the user did not ask for a metrics file or a trace file). */
+        Metrics* metrics;
+
+        /** The path of the JSON file where the {@link #metrics} are saved (empty if they are not measured). */
+        string metricsPath;
+
+        /** The path of the file where the timeline of the threads is saved in the Chrome trace event format (empty if it is not recorded). */
+        string tracePath;
+
+        /** Writes the report while the pairs are aligned (null in a database search, whose report is written at the end). */
+        ReportWriter* writer;
+
+        /** Reads the batches of the input file in a pipelined execution (otherwise null). */
+        BatchReader* reader;
+
+        /** The batch whose pairs are in the {@link #data} (null if the execution is not pipelined). */
+        PairBatch* currentBatch;
+
+        /** The batch before the {@link #currentBatch}, which is kept until all of its pairs are written (otherwise null). */
+        PairBatch* previousBatch;
+
+        /**
+         * This abstract method executes the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * for the pairs of the {@link #data} member-variable (all the input pairs, or a batch of them), and has to be implemented
+         * in all descendant classes. The statistics of successive calls are accumulated.
+         */
+        virtual void alignPairs(void) = 0;
+
+        /**
+         * Must be called when the scoring matrix of an input pair has been filled, before any traceback. It decides whether the
+         * pair passes the {@link #minScore} filter, otherwise the pair is dropped from the report and its cell updates are counted.
+         * While the pairs are scored for the {@link #topK} filter, it only stores the score, so no pair is traced back.
+         * It may be called by multiple threads at the same time.
+         * @param i The index of the input pair in the {@link #data} vector.
+         * @param score The maximum value of the scoring matrix of the pair (0 if it has no cell with a positive value).
+         * @return True if the alignments of the pair have to be traced back (and #completeResults() called), otherwise false.
+         */
+        bool keepPair(size_t i, int score);
+
         /**
-         * Provides the current time (since the
-         * <a href="https://en.wikipedia.org/wiki/Epoch_(computing)">Epoch</a>) in seconds.
-         * @return A long double variable with the number of seconds elapsed since the Epoch.
+         * Provides the number of cells of the scoring matrix of an input pair that were computed, which are counted in the
+         * {@link Statistics#cellUpdates} when the pair is complete (see #completeResults()) or dropped (see #keepPair()).
+         * @param i The index of the input pair in the {@link #data} vector.
+         * @return A long long integer with |Q|*|D| by default, unless a version computes only a part of the matrix.
+         */
+        virtual long long int pairCells(size_t i);
+
+        /**
+         * Searches the {@link #cache} for a pair of sequences which is identical to an input pair and, if it is found,
+         * copies its alignments into the {@link #results} of the input pair and hands them to the report (see #writeResults()).
+         * Their score passes through the filters like the score of an aligned pair (see #keepPair()).
+         * @param i The index of the input pair in the {@link #data} vector.
+         * @return True if the alignments were found (so the pair does not need to be aligned), otherwise false.
+         */
+        bool reuseResults(size_t i);
+
+        /**
+         * Must be called when all the alignments of an input pair are in the {@link #results}. It removes the identical ones
+         * (if Scores#collapseAlignments is set), stores them into the
+         * {@link #cache}, hands them to the report (see #writeResults()) and counts the cell updates of the pair.
+         * It may be called by multiple threads at the same time.
+         * @param i The index of the input pair in the {@link #data} vector.
+         */
+        void completeResults(size_t i);
+
+        /**
+         * Hands the alignments of an input pair over to the {@link #writer} (if the report is written while the pairs are aligned),
+         * so that they no longer occupy memory, or to the {@link #consumer} of the pairs that are aligned in memory.
+         * @param i The index of the input pair in the {@link #data} vector.
+         */
+        void writeResults(size_t i);
+
+        /**
+         * Provides the current time of a monotonic clock (see Metrics#now()) in seconds, so that the differences between two
+         * calls are not affected by changes of the system time.
+         * @return A long double variable with the number of seconds elapsed since an arbitrary point.
          */
         long double getTime(void);
 
+        /**
+         * Extracts the aligned sequences from the scoring matrix, by following the cells whose values
+         * produced the value of the cell where the traceback begins (the diagonally up left cell is preferred, then
+         * the left and then the up cell). The process is iterative and stops when it reaches a cell which is preceded
+         * by a zero cell.
+         * @param sequences A {@link Pair} object with the sequences that are aligned.
+         * @param scoring_matrix The scoring matrix, i.e. any object that provides the value of a cell as {@code scoring_matrix(row, col)}.
+         * @param row The row of the cell where the traceback begins.
+         * @param col The column of the cell where the traceback begins.
+         * @param result A {@link Result} object, whose aligned sequences and start are set.
+         * @return A long long integer with the number of traceback steps that were performed.
+         */
+        template<class Matrix>
+        long long int traceback(const Pair& sequences, const Matrix& scoring_matrix, unsigned int row, unsigned int col, Result& result);
+
+        /**
+         * Performs the traceback process of #traceback(), but the aligned sequences are extended in reverse order
+         * (i.e. the caller has to reverse them when the traceback is complete), and the traceback may also stop
+         * when it moves above a given row.
+         * @param sequences A {@link Pair} object with the sequences that are aligned.
+         * @param scoring_matrix The scoring matrix, i.e. any object that provides the value of a cell as {@code scoring_matrix(row, col)}.
+         * @param row The row of the cell where the traceback begins. It is updated with the row where the traceback stopped.
+         * @param col The column of the cell where the traceback begins. It is updated with the column where the traceback stopped.
+         * @param min_row The traceback stops if it moves to a row above this one.
+         * @param result A {@link Result} object, whose (reversed) aligned sequences are extended and whose start is set if a
+         * zero cell is reached.
+         * @return A long long integer with the number of traceback steps that were performed.
+         */
+        template<class Matrix>
+        long long int extendTraceback(const Pair& sequences, const Matrix& scoring_matrix, unsigned int& row, unsigned int& col,
+                                      unsigned int min_row, Result& result);
+
     private:
+        /**
+         * Removes from the {@link #data} the pairs that are not among the {@link #topK} best ones (the input order breaks ties), or
+         * whose score is below the {@link #minScore}, before any of them is traced back. The pairs are scored by #alignPairs() itself,
+         * i.e. with the kernel and the threads of the version, but without any traceback (see #keepPair()). The best pairs are found
+         * with a heap of at most {@link #topK} pairs, and the remaining pairs keep their order, while their original indices are stored
+         * into the {@link #selection}. Without the {@link #topK} filter, the pairs are filtered only after their scoring matrices are filled.
+         */
+        void filterPairs(void);
+
+        /**
+         * Aligns the {@link #data} with #alignPairs(). While the report is written in the background, the pairs are aligned in windows
+         * of at most {@link #WINDOW_PAIRS} consecutive pairs, so that the versions that do not finish the pairs in the input order
+         * (e.g. the largest ones first) cannot make the writer keep more than a window of finished pairs that wait for an earlier one.
+         */
+        void alignWindows(void);
+
+        /**
+         * The maximum number of pairs that #alignWindows() aligns together while the report is written in the background. It is a part
+         * of the pairs that the writer may keep in memory (see ReportWriter#MAX_PENDING), so the writer can always make progress.
+         */
+        static const size_t WINDOW_PAIRS = 256;
+
+        /**
+         * Applies the filters to the score of a pair: it stores the score while the pairs are scored for the {@link #topK} filter,
+         * or drops the pair from the report if the score is below the {@link #minScore}.
+         * @param i The index of the input pair in the {@link #data} vector.
+         * @param score The score of the best local alignment of the pair.
+         * @return True if the pair is reported, otherwise false.
+         */
+        bool passFilters(size_t i, int score);
+
         /**
          * Reads the required arguments from console, by making appropriate questions to the user.
          */
@@ -186,7 +508,82 @@ class Framework {
         /**
          * Reads the input sequences (which need alignment) from a file whose path is given by
          * {@link #path} member-variable.
-         * It stores them into the {@link #data} member-variable.
+         * It packs them into the {@link #sequenceStore} and stores the pairs into the {@link #data} member-variable.
          */
         void readInputFile(void);
+
+        /**
+         * Reads the Q sequence of a database search from the file given by {@link #queryPath} and the D sequences
+         * from the file given by {@link #databasePath}. The sequences are packed into the {@link #sequenceStore}, and the Q sequence is
+         * paired with every D sequence into the {@link #data} member-variable.
+         */
+        void readDatabaseFiles(void);
 };
+
+template<class Matrix>
+long long int Framework::traceback(const Pair& sequences, const Matrix& scoring_matrix, unsigned int row, unsigned int col, Result& result){
+    long long int steps;
+
+    //the alignment is written backwards into preallocated strings, and it is reversed once at the end
+    result.result_pair.q.clear();
+    result.result_pair.d.clear();
+    result.result_pair.q.reserve(row+col);
+    result.result_pair.d.reserve(row+col);
+
+    steps = extendTraceback(sequences, scoring_matrix, row, col, 1, result);
+
+    reverse(result.result_pair.q.begin(), result.result_pair.q.end());
+    reverse(result.result_pair.d.begin(), result.result_pair.d.end());
+    return steps;
+}
+
+template<class Matrix>
+long long int Framework::extendTraceback(const Pair& sequences, const Matrix& scoring_matrix, unsigned int& row, unsigned int& col,
+                                         unsigned int min_row, Result& result){
+    string& aligned_q = result.result_pair.q;
+    string& aligned_d = result.result_pair.d;
+    long long int steps = 0;
+    int n1, n2, n3, current;
+    unsigned int start_col;
+
+    while(true){
+        current = scoring_matrix(row, col);
+        start_col = col;
+
+        //Compute values of left, up, and diagonally left cell of cell [row,col]
+        if(sequences.q[row-1]==sequences.d[col-1])  //diagonally up left (the codes of the symbols are compared)
+            n1 = scoring_matrix(row-1, col-1) + algoScores.matchScore;
+        else
+            n1 = scoring_matrix(row-1, col-1) + algoScores.mismatchScore;
+        n2 = scoring_matrix(row, col-1) + algoScores.gapScore;  //left
+        n3 = scoring_matrix(row-1, col) + algoScores.gapScore;  //up
+
+        if(current==n1){  //diagonally
+            aligned_q += sequences.q.symbol(row-1);
+            aligned_d += sequences.d.symbol(col-1);
+            row--;
+            col--;
+        }
+        else if(current==n2){  //left
+            aligned_q += '-';
+            aligned_d += sequences.d.symbol(col-1);
+            col--;
+        }
+        else if(current==n3){  //up
+            aligned_q += sequences.q.symbol(row-1);
+            aligned_d += '-';
+            row--;
+        }
+        else
+            return steps;
+        steps++;
+
+        //if the preceding cell is zero, then the alignment starts at the current cell
+        if(scoring_matrix(row, col)==0){
+            result.start = start_col-1;
+            return steps;
+        }
+        if(row<min_row)
+            return steps;
+    }
+}
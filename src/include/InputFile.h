@@ -0,0 +1,74 @@
+/**
+ * @file InputFile.h
+ */
+#pragma once
+
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/**
+ * An input file which is mapped into memory (or read at once where memory mapping is not
+ * available or the file fills its last page exactly), so that its sequences can be used in place without being copied. The mapping is
+ * private: the sequences that span multiple lines are compacted inside the mapped memory, while the
+ * file itself is never modified. The memory remains valid until the object is destroyed.
+ * @author Georgios Apostolakis
+ */
+class InputFile {
+    public:
+        /**
+         * Constructs a new instance of this class, without any file.
+         */
+        InputFile(void);
+
+        /**
+         * Destroys an instance of the current class and releases the memory of its file.
+         */
+        ~InputFile(void);
+
+        /**
+         * Maps a file into memory (any previous file is released).
+         * @param path The path of the file.
+         * @return False if the file cannot be opened, otherwise true.
+         */
+        bool open(const string& path);
+
+        /**
+         * Provides the next token of the file, i.e. the next group of characters which are not whitespace.
+         * @return A view of the token inside the memory of the file, which is empty at the end of the file.
+         */
+        string_view next_token(void);
+
+        /**
+         * Appends a token to a sequence, by moving the token right after the end of the sequence
+         * in the memory of the file. Both of them must have been provided by #next_token() (or by earlier
+         * calls of this method), and the token must come after the sequence.
+         * @param sequence A view of the sequence (empty for a new sequence).
+         * @param token A view of the token.
+         * @return A view of the extended sequence.
+         */
+        string_view concatenate(string_view sequence, string_view token);
+
+    private:
+        /** The contents of the file, followed by a zero. */
+        char* buffer;
+
+        /** The size of the file in bytes. */
+        size_t size;
+
+        /** The position of the next character that #next_token() examines. */
+        size_t cursor;
+
+        /** True if the {@link #buffer} was mapped into memory, false if it was allocated and read. */
+        bool mapped;
+
+        /**
+         * Releases the memory of the file.
+         */
+        void close(void);
+
+        InputFile(const InputFile&) = delete;
+        InputFile& operator=(const InputFile&) = delete;
+};
@@ -0,0 +1,184 @@
+/**
+ * @file LinearSpaceImplementation.h
+ */
+#pragma once
+
+#include "Framework.h"
+
+using namespace std;
+
+/**
+* A cell with maximum value in the scoring matrix, together with the data required
+* for the reconstruction of its alignment in linear space.
+* @author Georgios Apostolakis
+*/
+struct OptimalCell {
+    /** The value of the cell (i.e. the score of its alignment). */
+    int score;
+
+    /** The cell with the maximum value, where the traceback begins. */
+    Position end;
+
+    /** The cell where the traceback that begins from {@link #end} stops. */
+    Position origin;
+
+    /** The values of the row above {@link #origin}, from the column before {@link #origin} up to the column of {@link #end}. */
+    vector<int> top;
+
+    /** The values of the column before {@link #origin}, from the row above {@link #origin} up to the row of {@link #end}. */
+    vector<int> left;
+};
+
+/**
+* A view of a rectangle of the scoring matrix (stored in a {@link ScoringMatrix} together with the row above
+* and the column before it), through the coordinates of its cells in the whole scoring matrix.
+* @author Georgios Apostolakis
+*/
+struct RectangleView {
+    /** The matrix where the rectangle is stored. */
+    const ScoringMatrix* rectangle;
+
+    /** The row of the scoring matrix which is stored at row 0 of the {@link #rectangle}. */
+    unsigned int row;
+
+    /** The column of the scoring matrix which is stored at column 0 of the {@link #rectangle}. */
+    unsigned int column;
+
+    /**
+     * Provides the value of a cell of the rectangle.
+     * @param row The row of the cell in the scoring matrix.
+     * @param col The column of the cell in the scoring matrix.
+     * @return An integer with the value of the cell.
+     */
+    int operator()(unsigned int row, unsigned int col) const {
+        return (*rectangle)(row-this->row, col-column);
+    }
+};
+
+/**
+ * This class extends the {@link Framework} class and implements the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+ * in a sequential manner (1 thread), with memory that grows linearly to the size of the sequences.
+ * The scoring matrix is never stored: a pass with 2 rows finds the cells with the maximum value (and the
+ * cells where their tracebacks stop) and then every alignment is reconstructed with a divide-and-conquer
+ * process in the spirit of <a href="https://doi.org/10.1093/bioinformatics/4.1.11">Myers and Miller</a>.
+ * The alignments are identical to those of the other implementations.
+ * @author Georgios Apostolakis
+ */
+class LinearSpaceImplementation : public Framework {
+    public:
+        /**
+         * Calls the Framework() constructor of the parent class. If no arguments are provided by the user,
+         * it asks for them through console questions. The valid arguments are
+         * the same with those listed in the documentation of the Framework() constructor. Any
+         * extra (and possibly invalid) arguments are ignored without throwing any exception.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         */
+        LinearSpaceImplementation(int argc, char* argv[]);
+
+        /**
+         * Destroys an instance of the current class by calling the ~Framework() destructor
+         * of the parent class.
+         */
+        virtual ~LinearSpaceImplementation();
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * in a sequential way (1 thread) and in linear space.
+         */
+        void alignPairs(void) final;
+
+        /**
+         * Prints some statistics into console about the execution details of the algorithm.
+         */
+        void printStatistics(void) final;
+
+    private:
+        /** The number of cells below which a rectangle of the scoring matrix is stored and traced back directly. */
+        static const size_t BASE_CELLS = 4096;
+
+        /** The direction of a traceback step towards the diagonally up left cell. */
+        static const int DIAGONAL = 0;
+
+        /** The direction of a traceback step towards the left cell. */
+        static const int LEFT = 1;
+
+        /** The direction of a traceback step towards the up cell. */
+        static const int UP = 2;
+
+        /** The matrix where the small rectangles are stored (reused for every rectangle). */
+        ScoringMatrix rectangle;
+
+        /** The maximum number of integers that were stored at the same time during the execution (for the statistics). */
+        size_t peakMemory;
+
+        /**
+         * Computes the value of a cell of the scoring matrix, together with the direction
+         * that the traceback follows when it reaches that cell.
+         * @param q The symbol of the Q sequence which corresponds to the row of the cell.
+         * @param d The symbol of the D sequence which corresponds to the column of the cell.
+         * @param diag The value of the diagonally up left cell.
+         * @param left The value of the left cell.
+         * @param up The value of the up cell.
+         * @param move An integer where the direction of the traceback ({@link #DIAGONAL}, {@link #LEFT} or {@link #UP}) is stored.
+         * @return An integer with the value of the cell.
+         */
+        int compute_cell(char q, char d, int diag, int left, int up, int& move);
+
+        /**
+         * Computes the scoring matrix row after row, keeping only 2 of them in memory. It finds the cells with
+         * maximum value and the cells where the tracebacks that begin from them stop.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param max_cells A vector with an {@link OptimalCell} object for every cell with maximum value (in row-major order).
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_scoring_rows(const Pair& sequences, vector<OptimalCell>& max_cells);
+
+        /**
+         * Computes the scoring matrix row after row once more, in order to store the values that surround
+         * the alignment of every cell with maximum value (i.e. the {@link OptimalCell#top top} and
+         * {@link OptimalCell#left left} members).
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param max_cells A vector with the {@link OptimalCell} objects found by #fill_scoring_rows().
+         */
+        void collect_boundaries(const Pair& sequences, vector<OptimalCell>& max_cells);
+
+        /**
+         * Reconstructs the part of an alignment which lies in a rectangle of the scoring matrix, by splitting the
+         * rectangle at its middle row until it becomes small enough to be stored. The traceback begins from
+         * the bottom right cell of the rectangle and stops either when it reaches a cell that is preceded by zero
+         * or when it leaves the rectangle from its top row.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param row0 The top row of the rectangle.
+         * @param col0 The left column of the rectangle.
+         * @param row1 The bottom row of the rectangle.
+         * @param col1 The right column of the rectangle.
+         * @param top The values of the row above the rectangle (from column {@code col0-1} up to {@code col1}).
+         * @param left The values of the column before the rectangle (from row {@code row0-1} up to {@code row1}).
+         * @param result A {@link Result} object, whose aligned sequences are extended (in reverse order) and whose start is set
+         * when the traceback stops.
+         * @return A long long integer with the number of traceback steps performed inside the rectangle.
+         */
+        long long int align_rectangle(const Pair& sequences, unsigned int row0, unsigned int col0, unsigned int row1, unsigned int col1,
+                                      const int* top, const int* left, Result& result);
+
+        /**
+         * Stores a small rectangle of the scoring matrix and performs the traceback inside it
+         * (see #align_rectangle() for the meaning of the arguments).
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param row0 The top row of the rectangle.
+         * @param col0 The left column of the rectangle.
+         * @param row1 The bottom row of the rectangle.
+         * @param col1 The right column of the rectangle.
+         * @param top The values of the row above the rectangle.
+         * @param left The values of the column before the rectangle.
+         * @param result A {@link Result} object, whose aligned sequences are extended (in reverse order).
+         * @return A long long integer with the number of traceback steps performed inside the rectangle.
+         */
+        long long int traceback(const Pair& sequences, unsigned int row0, unsigned int col0, unsigned int row1, unsigned int col1,
+                                const int* top, const int* left, Result& result);
+};
@@ -0,0 +1,60 @@
+/**
+ * @file MatrixArena.h
+ */
+#pragma once
+
+#include <stdlib.h>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+ * A memory buffer that holds the cells of a scoring matrix and is reused for
+ * every pair of sequences. It is aligned to the size of a cache line and it grows
+ * only when a larger matrix than any previous one is requested. Its contents are
+ * never initialized (the algorithm writes every cell before reading it).
+ * @author Georgios Apostolakis
+ */
+class MatrixArena {
+    public:
+        /** The alignment of the buffer in bytes (i.e. the size of a cache line). */
+        static const size_t ALIGNMENT = 64;
+
+        /**
+         * Constructs a new (empty) instance of this class.
+         */
+        MatrixArena(void);
+
+        /**
+         * Destroys an instance of the current class and releases its buffer.
+         */
+        ~MatrixArena(void);
+
+        /**
+         * Provides a buffer of (at least) the requested size. The previous buffer is reused
+         * if it is large enough, otherwise it is released and a larger one is allocated.
+         * @param bytes The number of bytes that are required.
+         * @return A pointer to the beginning of the buffer, aligned to {@link #ALIGNMENT} bytes.
+         * @throws std::bad_alloc Thrown if the memory cannot be allocated.
+         */
+        void* reserve(size_t bytes);
+
+        /**
+         * Provides the number of times that memory has been allocated by this arena.
+         * @return A long long integer with the number of allocations.
+         */
+        long long int getAllocations(void) const;
+
+    private:
+        /** The buffer of the arena. */
+        void* buffer;
+
+        /** The size of the buffer in bytes. */
+        size_t capacity;
+
+        /** The number of times that memory has been allocated. */
+        long long int allocations;
+
+        MatrixArena(const MatrixArena&) = delete;
+        MatrixArena& operator=(const MatrixArena&) = delete;
+};
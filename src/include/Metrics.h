@@ -0,0 +1,280 @@
+/**
+ * @file Metrics.h
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+/**
+* The phases of an execution of the algorithm, whose time is measured separately by the {@link Metrics}.
+* @author Georgios Apostolakis
+*/
+enum Phase {
+    /** Reading and packing the input sequences. */
+    PARSE_PHASE,
+
+    /** Allocating the memory of the scoring matrices. */
+    ALLOCATE_PHASE,
+
+    /** Computing the cells of the scoring matrices. */
+    FILL_PHASE,
+
+    /** Searching for the cells with the maximum value, for the versions that do it in a separate pass after the fill. */
+    MAX_SCAN_PHASE,
+
+    /** Tracing back the optimal alignments. */
+    TRACEBACK_PHASE,
+
+    /** Writing the report. */
+    WRITE_PHASE,
+
+    /** The number of phases. */
+    PHASES
+};
+
+/**
+* The hardware counters of a thread, read through <a href="https://man7.org/linux/man-pages/man2/perf_event_open.2.html">perf_event_open</a>.
+* @author Georgios Apostolakis
+*/
+enum HardwareCounter {
+    /** The CPU cycles. */
+    CYCLES_COUNTER,
+
+    /** The retired instructions. */
+    INSTRUCTIONS_COUNTER,
+
+    /** The read misses of the last level cache. */
+    LLC_MISSES_COUNTER,
+
+    /** The mispredicted branches. */
+    BRANCH_MISSES_COUNTER,
+
+    /** The number of counters. */
+    COUNTERS
+};
+
+/**
+* A phase of a thread, as it is recorded into the trace of an execution.
+* @author Georgios Apostolakis
+*/
+struct TraceEvent {
+    /** The {@link Phase}. */
+    Phase phase;
+
+    /** The time when the phase started (see Metrics#now()). */
+    long double begin;
+
+    /** The time when the phase ended. */
+    long double end;
+
+    /** The index of the pair in the input file (or -1 if the phase does not concern a single pair). */
+    long long int pair;
+
+    /** The anti-diagonal of the tile, for the tiles of the fine-grained version (otherwise -1). */
+    long long int diagonal;
+
+    /** The index of the tile in its anti-diagonal, for the tiles of the fine-grained version (otherwise -1). */
+    long long int tile;
+};
+
+/**
+* The measurements of a single thread. Every thread updates only its own object, so no locking is needed, and the objects are
+* aligned to cache lines so that the threads do not share them.
+* @author Georgios Apostolakis
+*/
+struct alignas(64) ThreadMetrics {
+    /** The time of every phase (in seconds), excluding the phases that were nested into it. */
+    long double seconds[PHASES];
+
+    /** The number of times that every phase was measured. */
+    long long int count[PHASES];
+
+    /** The phase that is being measured (or -1). */
+    int active;
+
+    /** The time when the {@link #active} phase started or was resumed. */
+    long double since;
+
+    /** The file descriptors of the hardware counters of the thread (-1 for the counters that are not available). */
+    int counters[COUNTERS];
+
+    /** The role of the thread (e.g. "reader"), or null for the threads that align the pairs. */
+    const char* name;
+
+    /** The phases of the thread in the order they ended, if a trace is recorded (only the thread itself appends to them). */
+    vector<TraceEvent> events;
+};
+
+/**
+ * A low-overhead instrumentation layer, which measures the time of every {@link Phase} of an execution per thread (with a
+ * monotonic clock), and the hardware counters of every thread where the operating system provides them (Linux only).
+ * The measurements are saved into a JSON file. It may also record a timeline of the phases of every thread, which is saved in the
+ * <a href="https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU">Chrome trace event format</a>
+ * (viewable in <a href="https://ui.perfetto.dev">Perfetto</a>). Every thread records into its own buffer, so recording needs no locks.
+ * The phases are measured with {@link PhaseTimer} objects, which do nothing when no instrumentation was requested.
+ * @author Georgios Apostolakis
+ */
+class Metrics {
+    public:
+        /** The number of events that every thread reserves in advance for the trace, so that its buffer rarely grows. */
+        static const size_t TRACE_RESERVE = 1<<14;
+
+        /**
+         * Constructs a new instance of this class (without any measurements).
+         * @param tracing True if the phases of every thread have to be recorded for the trace (see #saveTrace()).
+         */
+        Metrics(bool tracing);
+
+        /**
+         * Closes the hardware counters and releases the measurements of the threads.
+         */
+        ~Metrics(void);
+
+        /**
+         * Provides the current time of a monotonic clock (which is not affected by changes of the system time).
+         * @return A long double with the time in seconds, since an arbitrary point.
+         */
+        static long double now(void){
+            return chrono::duration<long double>(chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+         * Provides the measurements of the calling thread, creating them (and opening its hardware counters) on the first call.
+         * @return The {@link ThreadMetrics} object of the calling thread.
+         */
+        ThreadMetrics& local(void);
+
+        /**
+         * Checks whether the phases are recorded for the trace.
+         * @return True if a trace is recorded, otherwise false.
+         */
+        bool isTracing(void) const {
+            return tracing;
+        }
+
+        /**
+         * Gives a role to the calling thread, which is shown in the measurements and in the trace.
+         * @param name The role of the thread (a string that is never released, e.g. a literal).
+         */
+        void setThreadName(const char* name);
+
+        /**
+         * Adds a value to the summary of the execution, which is saved together with the measurements.
+         * @param name The name of the value.
+         * @param value The value.
+         */
+        void set(const string& name, long double value);
+
+        /**
+         * Saves the summary and the measurements of all the threads into a JSON file.
+         * @param path The path of the file.
+         * @throws std::ios_base::failure Thrown if the file cannot be written.
+         */
+        void save(const string& path);
+
+        /**
+         * Saves the recorded phases of all the threads into a file in the Chrome trace event format, where every thread is a row
+         * of the timeline. It must be called after the threads have stopped recording.
+         * @param path The path of the file.
+         * @throws std::ios_base::failure Thrown if the file cannot be written.
+         */
+        void saveTrace(const string& path);
+
+    private:
+        /** The measurements of every thread that measured a phase, in the order of their first measurement. */
+        vector<ThreadMetrics*> threads;
+
+        /** The summary of the execution. */
+        vector<pair<string, long double>> summary;
+
+        /** A lock that protects the {@link #threads}. */
+        mutex lock;
+
+        /** True if the phases are recorded for the trace. */
+        bool tracing;
+
+        /** The time when this object was constructed, where the timeline of the trace starts. */
+        long double origin;
+
+        /** A number that identifies this object, so that a thread never uses the measurements of a deleted object. */
+        unsigned long long int id;
+
+        /** The number of objects of this class that have been created. */
+        static atomic<unsigned long long int> instances;
+
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+};
+
+/**
+ * Measures a {@link Phase} of the calling thread, from its construction until #stop() is called (or until it is destroyed).
+ * If another phase is measured at the same time, that phase is paused, so the time of every phase excludes its nested phases.
+ * When the {@link Metrics} object is null, it does not even read the clock.
+ * @author Georgios Apostolakis
+ */
+class PhaseTimer {
+    public:
+        /**
+         * Starts measuring a phase.
+         * @param metrics The {@link Metrics} object (or null if nothing has to be measured).
+         * @param phase The {@link Phase}.
+         */
+        PhaseTimer(Metrics* metrics, Phase phase):
+            PhaseTimer(metrics, phase, -1, -1, -1) {}
+
+        /**
+         * Starts measuring a phase of a single pair.
+         * @param metrics The {@link Metrics} object (or null if nothing has to be measured).
+         * @param phase The {@link Phase}.
+         * @param pair The index of the pair in the input file, which is shown in the trace.
+         */
+        PhaseTimer(Metrics* metrics, Phase phase, long long int pair):
+            PhaseTimer(metrics, phase, pair, -1, -1) {}
+
+        /**
+         * Starts measuring a phase of a tile of a scoring matrix.
+         * @param metrics The {@link Metrics} object (or null if nothing has to be measured).
+         * @param phase The {@link Phase}.
+         * @param pair The index of the pair in the input file (or -1), which is shown in the trace.
+         * @param diagonal The anti-diagonal of the tile, which is shown in the trace.
+         * @param tile The index of the tile in its anti-diagonal, which is shown in the trace.
+         */
+        PhaseTimer(Metrics* metrics, Phase phase, long long int pair, long long int diagonal, long long int tile);
+
+        /**
+         * Stops measuring the phase, if #stop() was not called.
+         */
+        ~PhaseTimer(void){
+            stop();
+        }
+
+        /**
+         * Stops measuring the phase and resumes the phase that it paused (if any).
+         */
+        void stop(void);
+
+    private:
+        /** The measurements of the calling thread (null if nothing is measured or if the phase has stopped). */
+        ThreadMetrics* slot;
+
+        /** The measured phase. */
+        Phase phase;
+
+        /** The phase that was paused by this one (or -1). */
+        int parent;
+
+        /** The event of the trace (only its phase and its begin are set until the phase stops), if a trace is recorded. */
+        TraceEvent event;
+
+        /** True if the phase is recorded for the trace. */
+        bool traced;
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
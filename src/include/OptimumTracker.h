@@ -0,0 +1,82 @@
+/**
+ * @file OptimumTracker.h
+ */
+#pragma once
+
+#include "Framework.h"
+
+using namespace std;
+
+/**
+ * Keeps the cells with the maximum value of a scoring matrix while it is filled, i.e. the cells where the optimal alignments end.
+ * Only cells with a value greater than zero are kept (a zero cell ends no alignment), and at most a given number of them:
+ * the first ones in row-major order, which are found with a heap when the cells do not arrive in that order (e.g. from the tiles
+ * of a wavefront). Thus its memory does not grow with the number of equal optima of repetitive sequences.
+ * @author Georgios Apostolakis
+ */
+class OptimumTracker {
+    public:
+        /**
+         * Constructs a new, empty tracker.
+         * @param limit The maximum number of cells that are kept (0 for all of them, see Scores#maxAlignments).
+         */
+        OptimumTracker(unsigned int limit = 0);
+
+        /**
+         * Forgets all the cells, so that the tracker can be used for another scoring matrix.
+         */
+        void reset(void);
+
+        /**
+         * Examines a cell of the scoring matrix.
+         * @param value The value of the cell.
+         * @param row The row of the cell.
+         * @param column The column of the cell.
+         */
+        void update(int value, unsigned int row, unsigned int column){
+            if(value<best || value<=0)
+                return;
+            if(value>best){ //a new maximum, so the cells of the previous one are no longer optimal
+                best = value;
+                positions.clear();
+            }
+            add(row, column);
+        }
+
+        /**
+         * Adds the cells of another tracker (e.g. of another thread that filled a part of the same scoring matrix).
+         * @param other The other tracker.
+         */
+        void merge(const OptimumTracker& other);
+
+        /**
+         * Provides the cells with the maximum value.
+         * @param max_pos A vector where the cells are stored, in row-major order (its previous contents are replaced).
+         */
+        void collect(vector<Position>& max_pos) const;
+
+        /**
+         * Provides the maximum value that has been found.
+         * @return An integer with the maximum value (0 if no cell is greater than zero).
+         */
+        int getMax(void) const {
+            return best;
+        }
+
+    private:
+        /** The maximum number of cells that are kept (0 for all of them). */
+        unsigned int limit;
+
+        /** The maximum value that has been found. */
+        int best;
+
+        /** The cells with the maximum value (a heap whose top is the last of them in row-major order, if there is a limit). */
+        vector<Position> positions;
+
+        /**
+         * Keeps a cell with the maximum value, unless the limit has been reached by cells that precede it in row-major order.
+         * @param row The row of the cell.
+         * @param column The column of the cell.
+         */
+        void add(unsigned int row, unsigned int column);
+};
\ No newline at end of file
@@ -0,0 +1,183 @@
+/**
+ * @file PackedSequence.h
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+
+using namespace std;
+
+/**
+* The symbols that appear in a set of sequences, together with their codes. The codes are
+* given to the symbols in ascending order, so the order of the codes is the order of the symbols.
+* @author Georgios Apostolakis
+*/
+struct Alphabet {
+    /** The number of bits of every code (1, 2, 4 or 8), i.e. the fewest bits which can hold the codes of all the symbols. */
+    unsigned int bits;
+
+    /** The number of symbols. */
+    unsigned int size;
+
+    /** The symbol of every code. */
+    char symbols[256];
+};
+
+/**
+* A sequence whose symbols are packed into codes of 1, 2, 4 or 8 bits (see {@link Alphabet}), inside the memory
+* of a {@link SequenceStore}. The kernels compare the codes of two sequences of the same store directly, since equal codes
+* mean equal symbols. The symbols are decoded only when the aligned sequences and the report are written.
+* @author Georgios Apostolakis
+*/
+class PackedSequence {
+    public:
+        /**
+         * Constructs an empty sequence.
+         */
+        PackedSequence(void);
+
+        /**
+         * Constructs a sequence from packed memory.
+         * @param words The memory of the codes.
+         * @param start The position of the first code of the sequence in the memory (in codes, not bits).
+         * @param length The number of symbols of the sequence.
+         * @param alphabet The {@link Alphabet} of the codes.
+         */
+        PackedSequence(const uint64_t* words, size_t start, size_t length, const Alphabet* alphabet);
+
+        /**
+         * Provides the number of symbols of the sequence.
+         * @return The size of the sequence.
+         */
+        size_t size(void) const {
+            return length;
+        }
+
+        /**
+         * Checks whether the sequence has no symbols.
+         * @return True if the sequence is empty, otherwise false.
+         */
+        bool empty(void) const {
+            return length==0;
+        }
+
+        /**
+         * Provides the code of a symbol of the sequence (without decoding it).
+         * @param i The position of the symbol.
+         * @return The code of the symbol.
+         */
+        unsigned char operator[](size_t i) const {
+            size_t bit = (start + i)*bits;  //the codes never cross a word, since the bits of a code divide 64
+            return (words[bit>>6]>>(bit&63)) & mask;
+        }
+
+        /**
+         * Provides (decodes) a symbol of the sequence.
+         * @param i The position of the symbol.
+         * @return The symbol.
+         */
+        char symbol(size_t i) const {
+            return alphabet->symbols[(*this)[i]];
+        }
+
+        /**
+         * Decodes the whole sequence.
+         * @return A string with the symbols of the sequence.
+         */
+        string str(void) const;
+
+        /**
+         * Compares the symbols of two sequences (which may belong to different stores).
+         * @param other The other sequence.
+         * @return True if the sequences have the same symbols, otherwise false.
+         */
+        bool operator==(const PackedSequence& other) const;
+
+        /**
+         * Compares the symbols of the sequence with a string.
+         * @param other The string.
+         * @return True if the sequence has the symbols of the string, otherwise false.
+         */
+        bool operator==(string_view other) const;
+
+        /**
+         * Compares the symbols of two sequences lexicographically (like strings).
+         * @param other The other sequence.
+         * @return True if this sequence comes before the other one, otherwise false.
+         */
+        bool operator<(const PackedSequence& other) const;
+
+    private:
+        /** The memory of the codes. */
+        const uint64_t* words;
+
+        /** The position of the first code of the sequence in the {@link #words}. */
+        size_t start;
+
+        /** The number of symbols of the sequence. */
+        size_t length;
+
+        /** The number of bits of every code. */
+        unsigned char bits;
+
+        /** A mask with the lowest {@link #bits} bits set. */
+        unsigned char mask;
+
+        /** The alphabet of the codes. */
+        const Alphabet* alphabet;
+};
+
+/**
+ * Writes the (decoded) symbols of a sequence into a stream.
+ * @param output The stream.
+ * @param sequence The {@link PackedSequence} object.
+ * @return The stream.
+ */
+ostream& operator<<(ostream& output, const PackedSequence& sequence);
+
+/**
+ * The memory of a set of packed sequences. The alphabet of the sequences is detected when they are packed, and every symbol
+ * takes only as many bits as the alphabet requires (e.g. a single bit for binary sequences, 2 bits for DNA), so the sequences
+ * occupy up to 8 times less memory than their text.
+ * @author Georgios Apostolakis
+ */
+class SequenceStore {
+    public:
+        /**
+         * Constructs a new (empty) instance of this class.
+         */
+        SequenceStore(void);
+
+        /**
+         * Packs a set of sequences (any previous contents of the store are released).
+         * @param sequences The symbols of the sequences.
+         * @param packed A vector where the packed sequences are stored, in the same order.
+         */
+        void pack(const vector<string_view>& sequences, vector<PackedSequence>& packed);
+
+        /**
+         * Provides the alphabet of the packed sequences.
+         * @return The {@link Alphabet} of the store.
+         */
+        const Alphabet& getAlphabet(void) const;
+
+        /**
+         * Provides the memory that the codes occupy.
+         * @return The size of the codes in bytes.
+         */
+        size_t getBytes(void) const;
+
+    private:
+        /** The codes of all the sequences, one after the other. */
+        vector<uint64_t> words;
+
+        /** The alphabet of the sequences. */
+        Alphabet alphabet;
+
+        SequenceStore(const SequenceStore&) = delete;
+        SequenceStore& operator=(const SequenceStore&) = delete;
+};
@@ -5,6 +5,7 @@
 
 #include "Framework.h"
 #include <omp.h>
+#include <deque>
 
 using namespace std;
 
@@ -13,7 +14,9 @@ using namespace std;
  * the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
  * in a parallel multi-threaded way.
  * Parallelization takes place in a coarse level, where different pairs
- * of sequences may be aligned by different threads.
+ * of sequences may be aligned by different threads. The pairs are dealt to the threads
+ * from the most expensive to the cheapest (the cost of a pair is estimated as |Q|*|D|), and
+ * a thread whose own pairs are finished steals pairs from the other threads.
  * @author Georgios Apostolakis
  */
 class ParallelCoarseOMPImplementation : public Framework {
@@ -27,7 +30,7 @@ class ParallelCoarseOMPImplementation : public Framework {
          * @param argc An integer with the size of the {@code argv} argument.
          * @param argv An array with the arguments provided by the user.
          * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
-         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing, or the number of threads is not positive.
          * @throws std::runtime_error Thrown if the contents of the input file are invalid.
          */
         ParallelCoarseOMPImplementation(int argc, char* argv[]);
@@ -43,7 +46,7 @@ class ParallelCoarseOMPImplementation : public Framework {
          * in a parallel way (multiple threads). Parallelization takes place
          * between different pairs of sequences, whose optimal alignment is computed.
          */
-        void runAlgorithm(void) final;
+        void alignPairs(void) final;
 
         /**
          * Prints some statistics into console about the execution details of the algorithm.
@@ -54,27 +57,42 @@ class ParallelCoarseOMPImplementation : public Framework {
         /** The maximum number of threads to use for parallelization **/
         unsigned int threads;
 
+        /** The indices of the pairs that every thread has to align, from the most expensive to the cheapest. */
+        vector<deque<size_t>> queues;
+
+        /** A lock for every queue of {@link #queues}. */
+        vector<omp_lock_t> locks;
+
+        /** The time that every thread spent on the pairs (for the statistics). */
+        vector<long double> busyTime;
+
+        /** The number of pairs that were stolen from the queue of another thread (for the statistics). */
+        long long int stolenPairs;
+
         /**
          * Fills the scoring matrix of the
          *<a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
          * in a sequential way (for the {@link Pair} of sequences provided as argument).
          * @param sequences A {@link Pair} object with the sequences that will be aligned.
-         * @param scoring_matrix A 2D matrix constructed of vectors, whose cells will be filled according to the process
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
          * defined by the algorithm. Every cell will contain an integer value.
          * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
          * @return A long long integer with the number of cells whose entries are greater than zero.
          */
-        long long int fill_scoring_matrix(Pair sequences, vector< vector<int> >& scoring_matrix, vector<Position>& max_pos);
+        long long int fill_scoring_matrix(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos);
 
         /**
-         * Performs a recursive process in order to extract the aligned sequences from the scoring matrix.
-         * @param steps The number of traceback steps performed until the beginning of the recursive method, increased by 1.
-         * @param start_row The row of the cell where the traceback will begin.
-         * @param start_col The column of the cell where the traceback will begin.
-         * @param sequences A {@link Pair} object with the sequences that will be aligned.
-         * @param scoring_matrix The scoring matrix constructed by the #fill_scoring_matrix() method.
-         * @param results_vec A vector whose entries are of type {@link Result} and holds all the optimal alignments for the given sequences.
-         * @return A long long integer with the number of total traceback steps that were required (i.e. the depth of the recursion).
+         * Deals the pairs to the {@link #queues} of the threads, from the most expensive to the cheapest one.
+         */
+        void schedule_pairs(void);
+
+        /**
+         * Provides the next pair that a thread has to align. It is the most expensive pair of the thread's own queue or,
+         * if that queue is empty, the most expensive pair of the queue of another thread.
+         * @param thread The number of the thread.
+         * @param pair A variable where the index of the pair is stored.
+         * @param stolen A counter which is increased if the pair was stolen from another thread.
+         * @return False if there are no pairs left in any queue, otherwise true.
          */
-        long long int traceback(int steps, int start_row, int start_col, Pair sequences, vector< vector<int> >& scoring_matrix, vector<Result>& results_vec);
-};
+        bool next_pair(unsigned int thread, size_t& pair, long long int& stolen);
+};
\ No newline at end of file
@@ -0,0 +1,76 @@
+/**
+ * @file ParallelHybridOMPImplementation.h
+ */
+#pragma once
+
+#include "WavefrontImplementation.h"
+#include <omp.h>
+
+using namespace std;
+
+/**
+ * This class extends the {@link WavefrontImplementation} class and implements
+ * the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+ * in a parallel multi-threaded way, which mixes the two levels of parallelization. The cost of every pair is
+ * estimated as |Q|*|D|, and the pairs whose cost reaches a threshold are aligned one by one with all the threads,
+ * whose scoring matrix is computed as a wavefront of tiles (like the fine-grained version). The rest of the pairs
+ * are then aligned by different threads, from the most expensive to the cheapest (like the coarse-grained version).
+ * Thus a few huge pairs do not keep a single thread busy while the others idle, and the many small pairs do not pay
+ * for the synchronization of the wavefront.
+ * @author Georgios Apostolakis
+ */
+class ParallelHybridOMPImplementation : public WavefrontImplementation {
+    public:
+        /**
+         * Calls the WavefrontImplementation() constructor of the parent class, which also determines the number of threads
+         * that will be used and the size of the tiles. The valid arguments are the same with the arguments listed in the
+         * documentation of the WavefrontImplementation() constructor, plus:
+         * - {@code -threshold <integer with the cost in cells from which a pair is aligned as a wavefront>} (optional, tuned
+         * automatically for every batch of pairs by default, see WavefrontImplementation#tune_threshold())<br>
+         * Any extra (and possibly invalid) arguments are ignored without throwing any exception.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments are missing, or the number of threads, the tile size or
+         * the threshold is not positive.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         */
+        ParallelHybridOMPImplementation(int argc, char* argv[]);
+
+        /**
+         * Destroys an instance of the current class by calling the ~WavefrontImplementation() destructor
+         * of the parent class.
+         */
+        virtual ~ParallelHybridOMPImplementation();
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * in a parallel way (multiple threads). The expensive pairs are aligned first, each of them by all the threads,
+         * and then the rest of the pairs are aligned in parallel, each of them by a single thread.
+         */
+        void alignPairs(void) final;
+
+        /**
+         * Prints some statistics into console about the execution details of the algorithm.
+         */
+        void printStatistics(void) final;
+
+    private:
+        /** The cost (in cells) from which a pair is aligned as a wavefront, as given by the user (0 if it is tuned automatically). */
+        long long int threshold;
+
+        /** The threshold that was used for the last batch of pairs (for the statistics). */
+        long long int usedThreshold;
+
+        /** The number of pairs that were aligned as a wavefront by all the threads (for the statistics). */
+        long long int wavefrontPairs;
+
+        /** The number of pairs that were aligned by a single thread (for the statistics). */
+        long long int singlePairs;
+
+        /** The time that was spent on the pairs aligned as a wavefront (for the statistics). */
+        long double wavefrontTime;
+
+        /** The time that was spent on the pairs aligned by single threads (for the statistics). */
+        long double singleTime;
+};
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+ * @file ReportWriter.h
+ */
+#pragma once
+
+#include "Framework.h"
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+using namespace std;
+
+/**
+ * Writes the report with the optimal alignments in the background, while the pairs are still being aligned.
+ * The alignments of every pair are handed to a writer thread as soon as the pair is finished (by any thread and
+ * in any order), and they are written in the order of the input pairs through a large buffer. Only the pairs
+ * that cannot be written yet (because an earlier pair is not finished) are kept in memory.
+ * @author Georgios Apostolakis
+ */
+class ReportWriter {
+    public:
+        /** The size of the buffer of the output file in bytes. */
+        static const size_t BUFFER_SIZE = 1<<20;
+
+        /** The number of pending pairs above which the threads that hand over pairs wait for the writer thread. */
+        static const size_t MAX_PENDING = 1024;
+
+        /**
+         * Opens the output file and starts the writer thread.
+         * @param path The path of the output file.
+         * @param metrics The {@link Metrics} where the writer thread measures the time of writing (or null).
+         * @throws std::ios_base::failure Thrown if the output file cannot be opened.
+         */
+        ReportWriter(const string& path, Metrics* metrics);
+
+        /**
+         * Writes any pending pairs, stops the writer thread and closes the output file.
+         */
+        ~ReportWriter(void);
+
+        /**
+         * Hands the alignments of a pair over to the writer thread. The pairs must be numbered from 0 without gaps (including the skipped ones, see #skip()).
+         * It waits while {@link #MAX_PENDING} pairs are pending, unless it hands over the pair that the writer thread waits for, so the callers
+         * must keep the number of pairs that are finished ahead of the others bounded (see Framework#alignWindows()).
+         * @param index The index of the pair in the input file.
+         * @param sequences A {@link Pair} object with the sequences of the pair (it must remain valid until it is written).
+         * @param results A vector with the alignments of the pair, which is moved into the writer.
+         */
+        void write(size_t index, const Pair& sequences, vector<Result>&& results);
+
+        /**
+         * Hands a pair over to the writer thread without writing it (e.g. a pair that did not pass a filter), so that the
+         * report continues with the next pair.
+         * @param index The index of the pair in the input file.
+         */
+        void skip(size_t index);
+
+        /**
+         * Waits until a number of pairs (the first ones) have been written, so that the memory of their sequences can be released.
+         * All of them must have been handed over already.
+         * @param count The number of pairs.
+         */
+        void wait(size_t count);
+
+        /**
+         * Waits until every pair has been written, stops the writer thread and closes the output file.
+         * @throws std::ios_base::failure Thrown if the output file could not be written.
+         */
+        void close(void);
+
+        /**
+         * Writes a pair and its alignments into a stream, in the format of the report.
+         * @param output The stream.
+         * @param sequences A {@link Pair} object with the sequences of the pair.
+         * @param results A vector with the alignments of the pair.
+         */
+        static void write_pair(ostream& output, const Pair& sequences, const vector<Result>& results);
+
+    private:
+        /** The report file. */
+        ofstream output;
+
+        /** Where the writer thread measures the time of writing (null if nothing is measured). */
+        Metrics* metrics;
+
+        /** The path of the report file. */
+        string path;
+
+        /** The buffer of the {@link #output} stream. */
+        vector<char> buffer;
+
+        /**
+         * A pair that has been handed over to the writer thread.
+         * @author Georgios Apostolakis
+         */
+        struct PendingPair {
+            /** The sequences of the pair. */
+            Pair sequences;
+
+            /** The alignments of the pair. */
+            vector<Result> results;
+
+            /** True if the pair is not written at all (see #skip()). */
+            bool skipped;
+        };
+
+        /** The pairs that have been handed over but not written yet, by their index. */
+        map<size_t, PendingPair> pending;
+
+        /** The index of the next pair that will be written. */
+        size_t next;
+
+        /** True when no more pairs will be handed over. */
+        bool closing;
+
+        /** A lock that protects the {@link #pending} pairs, {@link #next} and {@link #closing}. */
+        mutex lock;
+
+        /** Signals the writer thread that a pair was handed over (or that the writer is closing). */
+        condition_variable handedOver;
+
+        /** Signals the waiting threads that a pair was written. */
+        condition_variable written;
+
+        /** The writer thread. */
+        thread worker;
+
+        /**
+         * The body of the writer thread, which writes the pending pairs in input order.
+         */
+        void run(void);
+
+        ReportWriter(const ReportWriter&) = delete;
+        ReportWriter& operator=(const ReportWriter&) = delete;
+};
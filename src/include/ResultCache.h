@@ -0,0 +1,180 @@
+/**
+ * @file ResultCache.h
+ */
+#pragma once
+
+#include "Framework.h"
+#include <unordered_map>
+#include <list>
+#include <mutex>
+
+using namespace std;
+
+/**
+* The key of an entry of a {@link ResultCache}: a 128-bit hash of the symbols of a pair of sequences, the
+* {@link Scores} of the algorithm and the variant of the alignments. The symbols (not the codes) are hashed, so the keys remain valid between runs
+* whose inputs have different alphabets.
+* @author Georgios Apostolakis
+*/
+struct CacheKey {
+    /** The first 64 bits of the hash. */
+    uint64_t high;
+
+    /** The last 64 bits of the hash. */
+    uint64_t low;
+
+    /**
+     * Compares two keys.
+     * @param other The other key.
+     * @return True if the keys are equal, otherwise false.
+     */
+    bool operator==(const CacheKey& other) const {
+        return high==other.high && low==other.low;
+    }
+};
+
+/**
+* The hash function of a {@link CacheKey}, for the unordered maps of a {@link ResultCache}.
+* @author Georgios Apostolakis
+*/
+struct CacheKeyHash {
+    /**
+     * Provides the hash of a key (the key is already a hash, so a part of it is enough).
+     * @param key The key.
+     * @return The hash of the key.
+     */
+    size_t operator()(const CacheKey& key) const {
+        return (size_t)key.low;
+    }
+};
+
+/**
+ * A content-addressed cache with the optimal alignments of the pairs of sequences that have
+ * already been aligned. An entry is found through the hash of the sequences of a pair together with
+ * the {@link Scores} of the algorithm (and the variant of the alignments), so identical pairs are aligned only once (within a run, or between
+ * runs if the cache is saved into a file). The number of entries is bounded, and the least recently used
+ * entries are evicted when it is exceeded. The entries are spread over shards with a lock each, so that
+ * it may be used by multiple threads at the same time without waiting for each other.
+ * @author Georgios Apostolakis
+ */
+class ResultCache {
+    public:
+        /**
+         * Constructs a new (empty) instance of this class.
+         * @param capacity The maximum number of entries (0 disables the cache, so every search is a miss). It is split evenly
+         * among the shards, so an entry may be evicted from its shard while other shards still have room.
+         */
+        ResultCache(size_t capacity);
+
+        /**
+         * Searches for the alignments of a pair and, if they are found, appends them to a vector
+         * (their {@link Result#ref_id ref_id} is replaced by the one provided).
+         * @param sequences A {@link Pair} object with the sequences to search for.
+         * @param scores The {@link Scores} of the algorithm.
+         * @param variant The variant of the alignments (see Framework#variant), so that e.g. the alignments found inside
+         * a band are never returned for an exact version.
+         * @param ref_id The ID of the pair which will be written in the alignments.
+         * @param results A vector where the alignments are appended.
+         * @return True if the pair was found (hit), otherwise false (miss).
+         */
+        bool find(const Pair& sequences, const Scores& scores, const string& variant, unsigned int ref_id, vector<Result>& results);
+
+        /**
+         * Stores the alignments of a pair (an existing entry of the same pair is kept). If the cache is full,
+         * the least recently used entry of the same shard is evicted.
+         * @param sequences A {@link Pair} object with the sequences that were aligned.
+         * @param scores The {@link Scores} of the algorithm.
+         * @param variant The variant of the alignments (see Framework#variant).
+         * @param results A vector with the alignments of the pair.
+         */
+        void insert(const Pair& sequences, const Scores& scores, const string& variant, const vector<Result>& results);
+
+        /**
+         * Reads the entries of a file that was produced by #save() and adds them to the cache (as long as they fit).
+         * A file that does not exist is not an error (the cache simply stays empty).
+         * @param path The path of the file.
+         * @throws std::runtime_error Thrown if the contents of the file are invalid.
+         */
+        void load(const string& path);
+
+        /**
+         * Writes all the entries of the cache into a file.
+         * @param path The path of the file.
+         * @throws std::ios_base::failure Thrown if the file cannot be opened.
+         */
+        void save(const string& path);
+
+        /**
+         * Provides the number of searches that found their pair in the cache.
+         * @return A long long integer with the number of hits.
+         */
+        long long int getHits(void) const;
+
+        /**
+         * Provides the number of searches that did not find their pair in the cache.
+         * @return A long long integer with the number of misses.
+         */
+        long long int getMisses(void) const;
+
+    private:
+        /** The maximum number of shards. */
+        static const size_t SHARDS = 16;
+
+        /**
+        * A part of the entries of the cache, protected by its own lock.
+        * @author Georgios Apostolakis
+        */
+        struct Shard {
+            /** The keys of the entries, from the most to the least recently used. */
+            list<CacheKey> usage;
+
+            /** The alignments of every entry, together with the position of its key in the {@link #usage}. */
+            unordered_map<CacheKey, pair<vector<Result>, list<CacheKey>::iterator>, CacheKeyHash> entries;
+
+            /** A lock that protects the entries of the shard from concurrent access. */
+            mutex lock;
+
+            /** The maximum number of entries of the shard (its share of the capacity of the cache). */
+            size_t capacity;
+        };
+
+        /** The shards of the entries. */
+        Shard shards[SHARDS];
+
+        /** The number of shards that are used, i.e. {@link #SHARDS}, unless the capacity is smaller. */
+        size_t shardCount;
+
+        /** The maximum number of entries of the cache. */
+        size_t capacity;
+
+        /** The number of searches that found their pair in the cache. */
+        atomic<long long int> hits;
+
+        /** The number of searches that did not find their pair in the cache. */
+        atomic<long long int> misses;
+
+        /**
+         * Provides the shard of a key.
+         * @param key The key.
+         * @return The shard where the key is stored.
+         */
+        Shard& shard(const CacheKey& key);
+
+        /**
+         * Stores an entry into its shard, evicting the least recently used entry if the shard is full.
+         * The lock of the shard must be held by the caller.
+         * @param target The shard of the key.
+         * @param key The key of the entry.
+         * @param results A vector with the alignments of the entry.
+         */
+        void store(Shard& target, const CacheKey& key, const vector<Result>& results);
+
+        /**
+         * Constructs the key of an entry by hashing the symbols of the sequences, the scores and the variant of the alignments.
+         * @param sequences A {@link Pair} object with the sequences.
+         * @param scores The {@link Scores} of the algorithm.
+         * @param variant The variant of the alignments.
+         * @return The {@link CacheKey} of the entry.
+         */
+        static CacheKey key(const Pair& sequences, const Scores& scores, const string& variant);
+};
\ No newline at end of file
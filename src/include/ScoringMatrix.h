@@ -0,0 +1,87 @@
+/**
+ * @file ScoringMatrix.h
+ */
+#pragma once
+
+#include "MatrixArena.h"
+
+using namespace std;
+
+/**
+ * The scoring matrix of the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>,
+ * stored row after row in a single {@link MatrixArena}. Every row begins at a cache line, and the memory is
+ * reused for all the pairs of sequences that are aligned with the same object (e.g. by the same thread).
+ * @author Georgios Apostolakis
+ */
+class ScoringMatrix {
+    public:
+        /**
+         * Constructs a new (empty) instance of this class.
+         */
+        ScoringMatrix(void);
+
+        /**
+         * Changes the dimensions of the matrix. Memory is allocated only if the new matrix does not fit in the
+         * memory of the previous ones, and the values of the cells are left uninitialized.
+         * @param rows The number of rows of the matrix (i.e. the size of the Q sequence plus 1).
+         * @param columns The number of columns of the matrix (i.e. the size of the D sequence plus 1).
+         */
+        void reshape(size_t rows, size_t columns);
+
+        /**
+         * Provides the number of rows of the matrix.
+         * @return The number of rows.
+         */
+        size_t size(void) const { return rows; }
+
+        /**
+         * Provides the number of columns of the matrix.
+         * @return The number of columns.
+         */
+        size_t columns(void) const { return cols; }
+
+        /**
+         * Provides a row of the matrix, so that a cell can be accessed as {@code scoring_matrix[row][col]}.
+         * @param row The index of the row.
+         * @return A pointer to the first cell of the row.
+         */
+        int* operator[](size_t row) { return cells + row*stride; }
+
+        /**
+         * Provides a row of the matrix, so that a cell can be accessed as {@code scoring_matrix[row][col]}.
+         * @param row The index of the row.
+         * @return A pointer to the first cell of the row.
+         */
+        const int* operator[](size_t row) const { return cells + row*stride; }
+
+        /**
+         * Provides the value of a cell of the matrix.
+         * @param row The row of the cell.
+         * @param col The column of the cell.
+         * @return An integer with the value of the cell.
+         */
+        int operator()(size_t row, size_t col) const { return cells[row*stride + col]; }
+
+        /**
+         * Provides the number of times that memory has been allocated for the matrix.
+         * @return A long long integer with the number of allocations.
+         */
+        long long int getAllocations(void) const { return arena.getAllocations(); }
+
+    private:
+        /** The memory where the cells are stored. */
+        MatrixArena arena;
+
+        /** The first cell of the matrix. */
+        int* cells;
+
+        /** The number of rows of the matrix. */
+        size_t rows;
+
+        /** The number of columns of the matrix. */
+        size_t cols;
+
+        /** The distance (in cells) between the beginnings of 2 consecutive rows. */
+        size_t stride;
+};
@@ -38,7 +38,7 @@ class SequentialImplementation : public Framework {
          * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
          * in a sequential way (1 thread).
          */
-        void runAlgorithm(void) final;
+        void alignPairs(void) final;
 
         /**
          * Prints some statistics into console about the execution details of the algorithm.
@@ -50,22 +50,10 @@ class SequentialImplementation : public Framework {
          * Fills the scoring matrix of the
          * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> sequentially.
          * @param sequences A {@link Pair} object with the sequences that will be aligned.
-         * @param scoring_matrix A 2D matrix constructed of vectors, whose cells will be filled according to the process
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
          * defined by the algorithm. Every cell will contain an integer value.
          * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
          * @return A long long integer with the number of cells whose entries are greater than zero.
          */
-        long long int fill_scoring_matrix(Pair sequences, vector< vector<int> >& scoring_matrix, vector<Position>& max_pos);
-
-        /**
-         * Performs a recursive process in order to extract the aligned sequences from the scoring matrix.
-         * @param steps The number of traceback steps performed until the beginning of the recursive method, increased by 1.
-         * @param start_row The row of the cell where the traceback will begin.
-         * @param start_col The column of the cell where the traceback will begin.
-         * @param sequences A {@link Pair} object with the sequences that will be aligned.
-         * @param scoring_matrix The scoring matrix constructed by the #fill_scoring_matrix() method.
-         * @param results_vec A vector whose entries are of type {@link Result} and holds all the optimal alignments for the given sequences.
-         * @return A long long integer with the number of total traceback steps that were required (i.e. the depth of the recursion).
-         */
-        long long int traceback(int steps, int start_row, int start_col, Pair sequences, vector< vector<int> >& scoring_matrix, vector<Result>& results_vec);
+        long long int fill_scoring_matrix(Pair sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos);
 };
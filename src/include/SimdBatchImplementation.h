@@ -0,0 +1,214 @@
+/**
+ * @file SimdBatchImplementation.h
+ */
+#pragma once
+
+#include "Framework.h"
+#include "SimdVector.h"
+
+using namespace std;
+
+/**
+* The scoring matrices of a batch of pairs, computed together with one pair in every 8-bit or 16-bit lane
+* of a SIMD register. The matrices are interleaved: cell {@code (row, col)} of every pair is stored
+* in consecutive lanes, so that the cell of all pairs is loaded with a single register.
+* @tparam Cell The type of the cells ({@code unsigned char} or {@code short}).
+* @author Georgios Apostolakis
+*/
+template<class Cell>
+struct BatchScoringMatrix {
+    /** The number of rows of the matrices (i.e. the size of the longest Q sequence of the batch plus 1). */
+    unsigned int rows;
+
+    /** The number of columns of the matrices (i.e. the size of the longest D sequence of the batch plus 1). */
+    unsigned int columns;
+
+    /** The number of lanes (i.e. the maximum number of pairs of a batch). */
+    unsigned int lanes;
+
+    /** The lane whose matrix is accessed by operator()(). */
+    unsigned int lane;
+
+    /** The memory where the cells are stored (reused for every batch). */
+    MatrixArena arena;
+
+    /** The cells of the matrices, row after row. */
+    Cell* cells;
+
+    /**
+     * Provides the value of a cell of the matrix of lane {@link #lane}.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return An integer with the value of the cell.
+     */
+    int operator()(unsigned int row, unsigned int col) const {
+        return cells[((size_t)row*columns + col)*lanes + lane];
+    }
+};
+
+/**
+ * This class extends the {@link Framework} class and implements the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+ * with an inter-sequence SIMD kernel (1 thread). The pairs are grouped into batches of pairs with
+ * similar sizes, and the scoring matrices of a batch are computed in lockstep, one pair in every saturating 8-bit lane
+ * (16 pairs with SSE4.1, 32 with AVX2). The pairs whose scores overflow 8 bits are computed again in batches of 16-bit lanes
+ * (8 pairs with SSE4.1, 16 with AVX2). The cells beyond the end of the shorter pairs are masked to zero,
+ * and every lane is traced back separately. It suits inputs with many short pairs; pairs whose
+ * scores may not fit in 16 bits, large pairs and positive gap scores are computed with the ordinary
+ * (scalar) process.
+ * @author Georgios Apostolakis
+ */
+class SimdBatchImplementation : public Framework {
+    public:
+        /**
+         * Calls the Framework() constructor of the parent class. If no arguments are provided by the user,
+         * it asks for them through console questions. The valid arguments are
+         * the same with those listed in the documentation of the Framework() constructor. Any
+         * extra (and possibly invalid) arguments are ignored without throwing any exception.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         */
+        SimdBatchImplementation(int argc, char* argv[]);
+
+        /**
+         * Destroys an instance of the current class by calling the ~Framework() destructor
+         * of the parent class.
+         */
+        virtual ~SimdBatchImplementation();
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with the inter-sequence SIMD kernel (1 thread).
+         */
+        void alignPairs(void) final;
+
+        /**
+         * Prints some statistics into console about the execution details of the algorithm.
+         */
+        void printStatistics(void) final;
+
+    private:
+        /** The maximum number of cells of the scoring matrix of a pair that is computed in a batch. */
+        static const long long int MAX_BATCH_CELLS = 1<<20;
+
+        /**
+         * The value that is added to the scores of the 8-bit kernel, so that they are never negative (the cells are unsigned).
+         * It is subtracted again after every diagonal step, so the lanes that would become negative stop at zero.
+         */
+        int bias;
+
+        /** The interleaved symbols of the Q sequences of an 8-bit batch (reused for every batch). */
+        vector<unsigned char> qSymbols8;
+
+        /** The interleaved symbols of the D sequences of an 8-bit batch (reused for every batch). */
+        vector<unsigned char> dSymbols8;
+
+        /** The interleaved row masks of an 8-bit batch, which are zero in the lanes whose Q sequence is shorter than the row. */
+        vector<unsigned char> rowMask8;
+
+        /** The interleaved column masks of an 8-bit batch, which are zero in the lanes whose D sequence is shorter than the column. */
+        vector<unsigned char> columnMask8;
+
+        /** The symbols of the Q sequences of a batch, interleaved like the cells of a {@link BatchScoringMatrix} (reused for every batch). */
+        vector<short> qSymbols;
+
+        /** The symbols of the D sequences of a batch, interleaved like the cells of a {@link BatchScoringMatrix} (reused for every batch). */
+        vector<short> dSymbols;
+
+        /** An interleaved mask for every row, which is zero in the lanes whose Q sequence is shorter than the row. */
+        vector<short> rowMask;
+
+        /** An interleaved mask for every column, which is zero in the lanes whose D sequence is shorter than the column. */
+        vector<short> columnMask;
+
+        /** The number of batches that were computed with the 8-bit SIMD kernel. */
+        long long int batches8;
+
+        /** The number of batches that were computed with the 16-bit SIMD kernel. */
+        long long int batches;
+
+        /** The number of pairs whose scores overflowed the 8-bit lanes, so they were computed again with the 16-bit kernel. */
+        long long int promotedPairs;
+
+        /**
+         * The size (in cells) of the smallest pair of an 8-bit batch where most lanes overflowed. The pairs of this size or larger
+         * are computed directly with the 16-bit kernel, since their scores are expected to overflow 8 bits as well.
+         */
+        long long int promotionCells;
+
+        /** The number of pairs that were computed with the scalar process instead of the SIMD kernel. */
+        long long int scalarPairs;
+
+        /** The number of cells computed by the SIMD kernel, including the masked ones (for the statistics). */
+        long long int laneCells;
+
+        /** The number of cells computed by the SIMD kernel which belong to the matrix of a pair (for the statistics). */
+        long long int usefulCells;
+
+        /**
+         * Fills the scoring matrices of a batch of pairs with the saturating 8-bit SIMD kernel.
+         * @param pairs The indices of the pairs of the batch (one for every lane).
+         * @param count The number of pairs of the batch (at most the number of 8-bit lanes).
+         * @param scoring_matrix A {@link BatchScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm.
+         * @param max_pos An array with a vector for every lane, whose entries are of type {@link Position} and hold the coordinates
+         * of the cells with maximum value (in row-major order). It stays empty for the lanes that overflowed.
+         * @param overflow A mask where the bit of every lane whose scores overflowed 8 bits is set (its cells are not valid).
+         * @return A long long integer with the number of cells whose entries are greater than zero (in the lanes that did not overflow).
+         */
+        long long int fill_scoring_matrix_8(const size_t* pairs, unsigned int count, BatchScoringMatrix<unsigned char>& scoring_matrix,
+                                            vector<Position>* max_pos, unsigned int& overflow);
+
+        /**
+         * Fills the scoring matrices of a batch of pairs with the 16-bit SIMD kernel.
+         * @param pairs The indices of the pairs of the batch (one for every lane).
+         * @param count The number of pairs of the batch (at most the number of 16-bit lanes).
+         * @param scoring_matrix A {@link BatchScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm.
+         * @param max_pos An array with a vector for every lane, whose entries are of type {@link Position} and hold the coordinates
+         * of the cells with maximum value (in row-major order).
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_scoring_matrix(const size_t* pairs, unsigned int count, BatchScoringMatrix<short>& scoring_matrix, vector<Position>* max_pos);
+
+        /**
+         * Traces back all the optimal alignments of a pair, whose scoring matrix has been filled, unless the pair does not pass
+         * the filters (see Framework#keepPair()).
+         * @param i The index of the pair in the {@link #data}.
+         * @param scoring_matrix The filled scoring matrix of the pair (a {@link ScoringMatrix} or a {@link BatchScoringMatrix}
+         * whose {@link BatchScoringMatrix#lane lane} is the one of the pair).
+         * @param max_pos The cells with the maximum value of the matrix.
+         */
+        template<class Matrix>
+        void trace_pair(size_t i, const Matrix& scoring_matrix, const vector<Position>& max_pos);
+
+        /**
+         * Fills the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> sequentially,
+         * one cell at a time. It is used for the pairs that the SIMD kernel cannot handle.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm. Every cell will contain an integer value.
+         * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_scoring_matrix_scalar(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos);
+
+        /**
+         * Decides whether a pair can be computed by the SIMD kernels, i.e. whether its scores always fit in 16 bits
+         * and its scoring matrix is small enough for a batch (the 8-bit kernel is tried first, see #fits_in_8_bits()).
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @return True if the pair can be computed in a batch, otherwise false.
+         */
+        bool fits_in_batch(const Pair& sequences);
+
+        /**
+         * Decides whether the scores can be held by the 8-bit kernel, i.e. whether the gap penalty and the scores
+         * increased by the {@link #bias} fit in 8 bits. The pairs may still overflow it, which is detected by the kernel.
+         * @return True if the 8-bit kernel can be used, otherwise false.
+         */
+        bool fits_in_8_bits(void);
+};
@@ -0,0 +1,211 @@
+/**
+ * @file SimdStripedImplementation.h
+ */
+#pragma once
+
+#include "Framework.h"
+#include "SimdVector.h"
+
+using namespace std;
+
+/**
+* A scoring matrix whose columns are stored in the striped layout of
+* <a href="https://doi.org/10.1093/bioinformatics/btl582">Farrar's algorithm</a>, with 8-bit or 16-bit cells.
+* Row {@code i+1} of a column is found at segment {@code i%segments} and lane {@code i/segments}.
+* @tparam Cell The type of the cells ({@code unsigned char} or {@code short}).
+* @author Georgios Apostolakis
+*/
+template<class Cell>
+struct StripedScoringMatrix {
+    /** The number of rows of the matrix (i.e. the size of the Q sequence plus 1). */
+    unsigned int rows;
+
+    /** The number of columns of the matrix (i.e. the size of the D sequence plus 1). */
+    unsigned int columns;
+
+    /** The number of SIMD registers (segments) required for a single column. */
+    unsigned int segments;
+
+    /** The number of lanes (i.e. cells) of every segment. */
+    unsigned int lanes;
+
+    /** The memory where the cells are stored (reused for every pair). */
+    MatrixArena arena;
+
+    /** The cells of the matrix, column after column (column 0 included). */
+    Cell* cells;
+
+    /**
+     * Provides the value of a cell of the matrix.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return An integer with the value of the cell.
+     */
+    int operator()(unsigned int row, unsigned int col) const {
+        if(row==0)
+            return 0;
+        return cells[(size_t)col*segments*lanes + ((row-1)%segments)*lanes + (row-1)/segments];
+    }
+};
+
+/**
+ * This class extends the {@link Framework} class and implements the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+ * with the striped SIMD kernel of <a href="https://doi.org/10.1093/bioinformatics/btl582">Farrar</a>
+ * (1 thread). Every column of the scoring matrix is computed with SIMD lanes (SSE4.1 or AVX2),
+ * followed by the lazy-F correction loop. A pair is first computed with saturating 8-bit lanes (twice as many lanes,
+ * half the memory), and only if its scores overflow 8 bits it is computed again with 16-bit lanes. A pair whose main diagonal alone
+ * already scores more than 8 (or 16) bits can hold skips the narrower kernel, and so does a pair whose score is expected to overflow
+ * 8 bits from the score per symbol of the previous pairs, so the pairs are rarely computed twice. The query profiles
+ * are reused by consecutive pairs with the same Q sequence, so a database search builds them only once. Pairs whose
+ * scores do not fit in 16 bits either, as well as positive gap scores, are computed with the ordinary (scalar) process.
+ * @author Georgios Apostolakis
+ */
+class SimdStripedImplementation : public Framework {
+    public:
+        /**
+         * Calls the Framework() constructor of the parent class. If no arguments are provided by the user,
+         * it asks for them through console questions. The valid arguments are
+         * the same with those listed in the documentation of the Framework() constructor. Any
+         * extra (and possibly invalid) arguments are ignored without throwing any exception.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         */
+        SimdStripedImplementation(int argc, char* argv[]);
+
+        /**
+         * Destroys an instance of the current class by calling the ~Framework() destructor
+         * of the parent class.
+         */
+        virtual ~SimdStripedImplementation();
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with the striped SIMD kernel (1 thread).
+         */
+        void alignPairs(void) final;
+
+        /**
+         * Prints some statistics into console about the execution details of the algorithm.
+         */
+        void printStatistics(void) final;
+
+    private:
+        /** The query profile, i.e. the striped match/mismatch scores of the Q sequence for every symbol of the D sequence. */
+        vector<short> profile;
+
+        /** The query profile of the 8-bit kernel, whose scores are increased by the {@link #bias}. */
+        vector<unsigned char> profile8;
+
+        /** The Q sequence of the {@link #profile} and the {@link #profile8}. */
+        string profileQuery;
+
+        /** The number of times that the profiles were built for a new Q sequence. */
+        long long int profiles;
+
+        /** The index of every symbol in the {@link #profile} (or -1 if the profile of the symbol has not been built yet). */
+        int profileIndex[256];
+
+        /** The index of every symbol in the {@link #profile8} (or -1 if the profile of the symbol has not been built yet). */
+        int profileIndex8[256];
+
+        /** A striped mask for every segment, which is zero in the lanes that do not correspond to a row of the matrix. */
+        vector<short> rowMask;
+
+        /** The striped mask of the 8-bit kernel, which is zero in the lanes that do not correspond to a row of the matrix. */
+        vector<unsigned char> rowMask8;
+
+        /** The value that is added to the scores of the {@link #profile8}, so that none of them is negative. */
+        int bias;
+
+        /**
+         * The average score per symbol of the recent pairs, i.e. their score divided by the length of their shorter sequence (the most
+         * recent pairs have the greatest weight). The pairs whose expected score overflows 8 bits are computed directly with 16 bits.
+         */
+        double scoreRate;
+
+        /** The number of pairs that were computed with the 8-bit kernel. */
+        long long int pairs8;
+
+        /** The number of pairs that were computed with the 16-bit kernel, since their scores overflow 8 bits. */
+        long long int pairs16;
+
+        /** The number of pairs that were computed with the scalar process instead of the SIMD kernel. */
+        long long int scalarPairs;
+
+        /**
+         * Fills the striped scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with the SIMD kernel.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix A {@link StripedScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm.
+         * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @param cells A long long integer where the number of cells whose entries are greater than zero is stored.
+         * @return False if the scores of the pair do not fit in 16 bits (and the matrix has to be computed again), otherwise true.
+         */
+        bool fill_scoring_matrix(const Pair& sequences, StripedScoringMatrix<short>& scoring_matrix, vector<Position>& max_pos, long long int& cells);
+
+        /**
+         * Fills the striped scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with the 8-bit SIMD kernel, whose lanes saturate instead of overflowing.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix A {@link StripedScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm.
+         * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @param cells A long long integer where the number of cells whose entries are greater than zero is stored.
+         * @return False if the scores of the pair may have saturated (and the matrix has to be computed with wider cells), otherwise true.
+         */
+        bool fill_scoring_matrix_8(const Pair& sequences, StripedScoringMatrix<unsigned char>& scoring_matrix, vector<Position>& max_pos, long long int& cells);
+
+        /**
+         * Computes a lower bound of the score of a pair, i.e. the score of the best segment of its main diagonal (an alignment
+         * without gaps), in time linear to the length of the sequences. The pairs whose bound overflows the cells of a kernel
+         * are computed directly with wider cells.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @return An integer with the score of the best segment of the main diagonal (at least 0).
+         */
+        int diagonal_score(const Pair& sequences);
+
+        /**
+         * Fills the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> sequentially,
+         * one cell at a time. It is used for the pairs that the SIMD kernel cannot handle.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm. Every cell will contain an integer value.
+         * @param max_pos A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_scoring_matrix_scalar(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos);
+
+        /**
+         * Computes the striped query profile of the Q sequence for a symbol of the D sequence
+         * (if it has not been computed already) and stores it into the {@link #profile}.
+         * @param q The Q sequence.
+         * @param symbol The (decoded) symbol of the D sequence.
+         * @param segments The number of segments of every column.
+         * @return A pointer to the first element of the profile of the symbol.
+         */
+        const short* profile_of(const PackedSequence& q, unsigned char symbol, unsigned int segments);
+
+        /**
+         * Computes the striped query profile of the 8-bit kernel (see #profile_of()) and stores it into the {@link #profile8}.
+         * @param q The Q sequence.
+         * @param symbol The (decoded) symbol of the D sequence.
+         * @param segments The number of segments of every column.
+         * @return A pointer to the first element of the profile of the symbol.
+         */
+        const unsigned char* profile8_of(const PackedSequence& q, unsigned char symbol, unsigned int segments);
+
+        /**
+         * Discards the query profiles and the row masks if they were built for a different Q sequence, and builds the row masks of
+         * the new one (the profiles themselves are built symbol by symbol, when they are needed).
+         * @param q The Q sequence.
+         */
+        void select_query(const PackedSequence& q);
+};
@@ -0,0 +1,356 @@
+/**
+ * @file SimdVector.h
+ */
+#pragma once
+
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+/** Defined when the translation unit is compiled with a supported instruction set (SSE4.1 or AVX2). */
+#define SIMD_SUPPORTED 1
+#endif
+
+#ifdef SIMD_SUPPORTED
+
+#if defined(__AVX2__)
+/** The type of a SIMD register (256 bits with AVX2). */
+typedef __m256i simd_vec;
+#else
+/** The type of a SIMD register (128 bits with SSE4.1). */
+typedef __m128i simd_vec;
+#endif
+
+/** The number of 16-bit lanes of a {@link simd_vec} register. */
+const int SIMD_LANES_16 = sizeof(simd_vec)/sizeof(short);
+
+/** The number of 8-bit lanes of a {@link simd_vec} register. */
+const int SIMD_LANES_8 = sizeof(simd_vec);
+
+/**
+ * Provides a register with all of its 16-bit lanes set to zero.
+ * @return A {@link simd_vec} register with zeros.
+ */
+inline simd_vec simd_zero(void){
+#if defined(__AVX2__)
+    return _mm256_setzero_si256();
+#else
+    return _mm_setzero_si128();
+#endif
+}
+
+/**
+ * Provides a register with all of its 16-bit lanes set to the same value.
+ * @param value The value of every lane.
+ * @return A {@link simd_vec} register with the given value in every lane.
+ */
+inline simd_vec simd_set1_i16(short value){
+#if defined(__AVX2__)
+    return _mm256_set1_epi16(value);
+#else
+    return _mm_set1_epi16(value);
+#endif
+}
+
+/**
+ * Provides a register with all of its 8-bit lanes set to the same value.
+ * @param value The value of every lane.
+ * @return A {@link simd_vec} register with the given value in every lane.
+ */
+inline simd_vec simd_set1_u8(unsigned char value){
+#if defined(__AVX2__)
+    return _mm256_set1_epi8((char)value);
+#else
+    return _mm_set1_epi8((char)value);
+#endif
+}
+
+/**
+ * Loads a register from memory (no alignment is required).
+ * @param address The address of the first 16-bit lane.
+ * @return A {@link simd_vec} register with the loaded lanes.
+ */
+inline simd_vec simd_load(const short* address){
+#if defined(__AVX2__)
+    return _mm256_loadu_si256((const simd_vec*)address);
+#else
+    return _mm_loadu_si128((const simd_vec*)address);
+#endif
+}
+
+/**
+ * Loads a register from memory (no alignment is required).
+ * @param address The address of the first 8-bit lane.
+ * @return A {@link simd_vec} register with the loaded lanes.
+ */
+inline simd_vec simd_load(const unsigned char* address){
+#if defined(__AVX2__)
+    return _mm256_loadu_si256((const simd_vec*)address);
+#else
+    return _mm_loadu_si128((const simd_vec*)address);
+#endif
+}
+
+/**
+ * Stores a register into memory (no alignment is required).
+ * @param address The address where the first 16-bit lane will be stored.
+ * @param a The register to store.
+ */
+inline void simd_store(short* address, simd_vec a){
+#if defined(__AVX2__)
+    _mm256_storeu_si256((simd_vec*)address, a);
+#else
+    _mm_storeu_si128((simd_vec*)address, a);
+#endif
+}
+
+/**
+ * Stores a register into memory (no alignment is required).
+ * @param address The address where the first 8-bit lane will be stored.
+ * @param a The register to store.
+ */
+inline void simd_store(unsigned char* address, simd_vec a){
+#if defined(__AVX2__)
+    _mm256_storeu_si256((simd_vec*)address, a);
+#else
+    _mm_storeu_si128((simd_vec*)address, a);
+#endif
+}
+
+/**
+ * Computes the bitwise AND of two registers.
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register with the result.
+ */
+inline simd_vec simd_and(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_and_si256(a, b);
+#else
+    return _mm_and_si128(a, b);
+#endif
+}
+
+/**
+ * Adds two registers lane by lane, with signed saturation of the 16-bit lanes.
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register with the saturated sums.
+ */
+inline simd_vec simd_adds_i16(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_adds_epi16(a, b);
+#else
+    return _mm_adds_epi16(a, b);
+#endif
+}
+
+/**
+ * Adds two registers lane by lane, with unsigned saturation of the 8-bit lanes (i.e. the sums stop at 255).
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register with the saturated sums.
+ */
+inline simd_vec simd_adds_u8(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_adds_epu8(a, b);
+#else
+    return _mm_adds_epu8(a, b);
+#endif
+}
+
+/**
+ * Subtracts two registers lane by lane, with unsigned saturation of the 8-bit lanes (i.e. the differences stop at 0).
+ * @param a The first operand.
+ * @param b The second operand, which is subtracted from the first one.
+ * @return A {@link simd_vec} register with the saturated differences.
+ */
+inline simd_vec simd_subs_u8(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_subs_epu8(a, b);
+#else
+    return _mm_subs_epu8(a, b);
+#endif
+}
+
+/**
+ * Computes the maximum of two registers lane by lane (unsigned 8-bit lanes).
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register with the maximum value of every lane.
+ */
+inline simd_vec simd_max_u8(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_max_epu8(a, b);
+#else
+    return _mm_max_epu8(a, b);
+#endif
+}
+
+/**
+ * Compares two registers lane by lane for equality (8-bit lanes).
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register whose lanes are all ones where {@code a==b} and zero elsewhere.
+ */
+inline simd_vec simd_cmpeq_u8(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_cmpeq_epi8(a, b);
+#else
+    return _mm_cmpeq_epi8(a, b);
+#endif
+}
+
+/**
+ * Compares two registers lane by lane (unsigned 8-bit lanes). There is no such instruction,
+ * so a lane is greater when it is not equal to the maximum of the other one and itself.
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register whose lanes are all ones where {@code a>b} and zero elsewhere.
+ */
+inline simd_vec simd_cmpgt_u8(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(a, b), b), _mm256_set1_epi8(-1));
+#else
+    return _mm_xor_si128(_mm_cmpeq_epi8(_mm_max_epu8(a, b), b), _mm_set1_epi8(-1));
+#endif
+}
+
+/**
+ * Computes the maximum of two registers lane by lane (signed 16-bit lanes).
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register with the maximum value of every lane.
+ */
+inline simd_vec simd_max_i16(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_max_epi16(a, b);
+#else
+    return _mm_max_epi16(a, b);
+#endif
+}
+
+/**
+ * Compares two registers lane by lane (signed 16-bit lanes).
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register whose lanes are all ones where {@code a>b} and zero elsewhere.
+ */
+inline simd_vec simd_cmpgt_i16(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_cmpgt_epi16(a, b);
+#else
+    return _mm_cmpgt_epi16(a, b);
+#endif
+}
+
+/**
+ * Compares two registers lane by lane for equality (16-bit lanes).
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return A {@link simd_vec} register whose lanes are all ones where {@code a==b} and zero elsewhere.
+ */
+inline simd_vec simd_cmpeq_i16(simd_vec a, simd_vec b){
+#if defined(__AVX2__)
+    return _mm256_cmpeq_epi16(a, b);
+#else
+    return _mm_cmpeq_epi16(a, b);
+#endif
+}
+
+/**
+ * Selects the bytes of two registers according to a mask.
+ * @param a The register whose bytes are selected where the mask is zero.
+ * @param b The register whose bytes are selected where the mask is set.
+ * @param mask A register whose bytes are all ones or zero (e.g. the result of a comparison).
+ * @return A {@link simd_vec} register with the selected bytes.
+ */
+inline simd_vec simd_blend(simd_vec a, simd_vec b, simd_vec mask){
+#if defined(__AVX2__)
+    return _mm256_blendv_epi8(a, b, mask);
+#else
+    return _mm_blendv_epi8(a, b, mask);
+#endif
+}
+
+/**
+ * Collects the most significant bit of every byte of a register.
+ * @param a The register to examine.
+ * @return An integer mask with 2 bits for every 16-bit lane.
+ */
+inline unsigned int simd_movemask(simd_vec a){
+#if defined(__AVX2__)
+    return (unsigned int)_mm256_movemask_epi8(a);
+#else
+    return (unsigned int)_mm_movemask_epi8(a);
+#endif
+}
+
+/**
+ * Moves every 16-bit lane of a register one position up (lane i goes to lane i+1).
+ * The highest lane is discarded and the lowest lane becomes zero.
+ * @param a The register to shift.
+ * @return The shifted {@link simd_vec} register.
+ */
+inline simd_vec simd_shift_lanes_i16(simd_vec a){
+#if defined(__AVX2__)
+    return _mm256_alignr_epi8(a, _mm256_permute2x128_si256(a, a, 0x08), 14);
+#else
+    return _mm_slli_si128(a, 2);
+#endif
+}
+
+/**
+ * Moves every 8-bit lane of a register one position up (lane i goes to lane i+1).
+ * The highest lane is discarded and the lowest lane becomes zero.
+ * @param a The register to shift.
+ * @return The shifted {@link simd_vec} register.
+ */
+inline simd_vec simd_shift_lanes_u8(simd_vec a){
+#if defined(__AVX2__)
+    return _mm256_alignr_epi8(a, _mm256_permute2x128_si256(a, a, 0x08), 15);
+#else
+    return _mm_slli_si128(a, 1);
+#endif
+}
+
+/**
+ * Computes the maximum value among the 16-bit lanes of a register.
+ * @param a The register to examine.
+ * @return A short integer with the maximum lane.
+ */
+inline short simd_hmax_i16(simd_vec a){
+    short lanes[SIMD_LANES_16];
+    short maxLane;
+
+    memcpy(lanes, &a, sizeof(simd_vec));
+    maxLane = lanes[0];
+    for(int i=1;i<SIMD_LANES_16;i++)
+        if(lanes[i]>maxLane)
+            maxLane = lanes[i];
+    return maxLane;
+}
+
+/**
+ * Computes the maximum value among the 8-bit lanes of a register.
+ * @param a The register to examine.
+ * @return An unsigned char with the maximum lane.
+ */
+inline unsigned char simd_hmax_u8(simd_vec a){
+    unsigned char lanes[SIMD_LANES_8];
+    unsigned char maxLane;
+
+    memcpy(lanes, &a, sizeof(simd_vec));
+    maxLane = lanes[0];
+    for(int i=1;i<SIMD_LANES_8;i++)
+        if(lanes[i]>maxLane)
+            maxLane = lanes[i];
+    return maxLane;
+}
+
+#endif
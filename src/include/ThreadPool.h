@@ -0,0 +1,235 @@
+/**
+ * @file ThreadPool.h
+ */
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A bounded queue of tasks, which many threads may push into and pop from at the same time without locks
+ * (the algorithm of <a href="https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue">Vyukov</a>:
+ * every slot has a sequence number, which tells the threads whether the slot is free to be written or ready to be read).
+ * @author Georgios Apostolakis
+ */
+class TaskQueue {
+    public:
+        /**
+         * Constructs a new, empty queue.
+         * @param capacity The maximum number of tasks in the queue (rounded up to a power of 2).
+         */
+        TaskQueue(size_t capacity);
+
+        /**
+         * Releases the tasks that were never popped.
+         */
+        ~TaskQueue(void);
+
+        /**
+         * Appends a task to the queue.
+         * @param task The task, which is owned by the queue until it is popped.
+         * @return False if the queue is full (the task is not appended), otherwise true.
+         */
+        bool push(function<void()>* task);
+
+        /**
+         * Removes the oldest task from the queue.
+         * @param task A variable where the task is stored (its owner is the caller from now on).
+         * @return False if the queue is empty, otherwise true.
+         */
+        bool pop(function<void()>*& task);
+
+    private:
+        /**
+         * A slot of the queue.
+         * @author Georgios Apostolakis
+         */
+        struct Slot {
+            /** The position of the queue that the slot waits to be written (if it is equal) or read (if it is greater by 1). */
+            atomic<size_t> sequence;
+
+            /** The task of the slot. */
+            function<void()>* task;
+        };
+
+        /** The slots of the queue, used as a ring. */
+        unique_ptr<Slot[]> slots;
+
+        /** The number of slots minus 1 (the number of slots is a power of 2). */
+        size_t mask;
+
+        /** The position where the next task is pushed (in its own cache line, since the producers update it). */
+        alignas(64) atomic<size_t> tail;
+
+        /** The position where the next task is popped (in its own cache line, since the consumers update it). */
+        alignas(64) atomic<size_t> head;
+
+        TaskQueue(const TaskQueue&) = delete;
+        TaskQueue& operator=(const TaskQueue&) = delete;
+};
+
+/**
+ * A pool of persistent worker threads, which are created once and execute the tasks that are submitted to them,
+ * so that no threads are created or woken up in teams for every parallel step (unlike an OpenMP parallel region). The tasks
+ * are kept in a lock-free {@link TaskQueue}, and a result of a task is provided through a future. In Linux every worker
+ * may be pinned to a different processor among those that the process is allowed to run on (while there are enough of them).
+ * The workers, and the threads that wait for a future, block on a condition variable when the queue is empty.
+ * It does not depend on OpenMP, so it can be used inside processes with their own OpenMP settings.
+ * @author Georgios Apostolakis
+ */
+class ThreadPool {
+    public:
+        /** The capacity of the queue of the tasks. */
+        static const size_t QUEUE_CAPACITY = 1<<12;
+
+        /**
+         * Constructs a new pool and starts its workers.
+         * @param workers The number of worker threads. With 0 workers, the tasks are executed only by the threads that wait for them
+         * (see #wait()).
+         * @param pin True if every worker is pinned to a different processor of the affinity mask of the calling thread
+         * (the extra workers, and the workers of systems without pinning, are not pinned).
+         * @throws std::system_error Thrown if the threads cannot be created.
+         */
+        ThreadPool(unsigned int workers, bool pin = true);
+
+        /**
+         * Waits for the workers to execute the tasks of the queue, and stops them (without workers, the remaining tasks are discarded).
+         */
+        ~ThreadPool(void);
+
+        /**
+         * Provides the number of worker threads.
+         * @return An unsigned integer with the number of workers.
+         */
+        unsigned int size(void) const {
+            return workers.size();
+        }
+
+        /**
+         * Provides the number of the calling thread in the pool.
+         * @return An unsigned integer between 0 and #size()-1 for the workers of the pool, or #size() for any other thread.
+         */
+        unsigned int index(void) const;
+
+        /**
+         * Submits a task to the workers. If the queue is full, the task is executed by the calling thread instead.
+         * @param task The task.
+         */
+        void post(function<void()> task);
+
+        /**
+         * Submits a task to the workers and provides its result. If the queue is full, the task is executed by the calling thread instead.
+         * @param task The task, any callable object without arguments.
+         * @return A future with the value returned by the task (or the exception thrown by it).
+         */
+        template<class Task>
+        future<decltype(declval<Task>()())> submit(Task task){
+            typedef decltype(declval<Task>()()) Value;
+            shared_ptr<packaged_task<Value()>> packaged = make_shared<packaged_task<Value()>>(task);
+            future<Value> result = packaged->get_future();
+            post([packaged]{ (*packaged)(); });
+            return result;
+        }
+
+        /**
+         * Waits until a future is ready. Meanwhile, the calling thread executes tasks of the queue, so it helps the workers
+         * (which also prevents a deadlock when it is called by a worker). When the queue is empty, it blocks until a task
+         * is submitted or finished, instead of spinning.
+         * @param result The future.
+         */
+        template<class Value>
+        void wait(const future<Value>& result){
+            while(result.wait_for(chrono::seconds(0))!=future_status::ready){
+                if(run_one())
+                    continue;
+                unique_lock<mutex> guard(lock);
+                waiting++;
+                atomic_thread_fence(memory_order_seq_cst);  //pairs with the fence of #notify_waiting(), so one of the two threads sees the other
+                progress.wait(guard, [this, &result]{
+                    return queued.load()>0 || result.wait_for(chrono::seconds(0))==future_status::ready;
+                });
+                waiting--;
+            }
+        }
+
+        /**
+         * Executes one task of the queue with the calling thread.
+         * @return False if the queue was empty, otherwise true.
+         */
+        bool run_one(void);
+
+        /**
+         * Provides the number of tasks that have been executed (by the workers or by the threads that helped them).
+         * @return A long long integer with the number of tasks.
+         */
+        long long int getExecutedTasks(void) const {
+            return executed;
+        }
+
+        /**
+         * Provides the number of workers that were pinned to a processor.
+         * @return An unsigned integer with the number of pinned workers (0 where pinning is not supported).
+         */
+        unsigned int getPinnedWorkers(void) const {
+            return pinned;
+        }
+
+    private:
+        /** The tasks that wait to be executed. */
+        TaskQueue queue;
+
+        /** The worker threads. */
+        vector<thread> workers;
+
+        /** The number of tasks in the {@link #queue}. */
+        atomic<long long int> queued;
+
+        /** The number of workers that wait on the {@link #wakeup}. */
+        atomic<int> sleeping;
+
+        /** The number of threads that wait for a future on the {@link #progress}. */
+        atomic<int> waiting;
+
+        /** The number of tasks that have been executed. */
+        atomic<long long int> executed;
+
+        /** The number of workers that were pinned to a processor. */
+        atomic<unsigned int> pinned;
+
+        /** True when the workers have to stop. */
+        bool stopping;
+
+        /** A lock that protects the {@link #stopping} flag and the sleep of the workers (the queue itself needs no lock). */
+        mutex lock;
+
+        /** Wakes up the sleeping workers when a task is submitted. */
+        condition_variable wakeup;
+
+        /** Wakes up the threads that wait for a future when a task is submitted or finished (see #wait()). */
+        condition_variable progress;
+
+        /** True if the workers are pinned to processors. */
+        bool pin;
+
+        /**
+         * Wakes up the threads that wait for a future, if there are any, after a task was submitted or finished.
+         */
+        void notify_waiting(void);
+
+        /**
+         * The main loop of a worker, which executes tasks until the pool is destroyed.
+         * @param number The number of the worker.
+         */
+        void run(unsigned int number);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,137 @@
+/**
+ * @file ThreadPoolImplementation.h
+ */
+#pragma once
+
+#include "WavefrontImplementation.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * This class extends the {@link WavefrontImplementation} class and implements
+ * the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+ * in a parallel multi-threaded way, with a {@link ThreadPool} of persistent workers instead of OpenMP. Like the hybrid
+ * version, the pairs whose cost (|Q|*|D|) reaches a threshold are aligned one by one with all the threads, and the rest of
+ * the pairs are aligned by different threads, from the most expensive to the cheapest. The tiles of a scoring matrix are
+ * tasks of the pool, and every tile is submitted as soon as the tile above it and the tile before it are computed, so the
+ * threads never wait at a barrier between two anti-diagonals. The thread that calls #alignPairs() is one of the threads.
+ * @author Georgios Apostolakis
+ */
+class ThreadPoolImplementation : public WavefrontImplementation {
+    public:
+        /**
+         * Calls the WavefrontImplementation() constructor of the parent class, which also determines the number of threads
+         * that will be used and the size of the tiles, and starts the threads. The valid arguments are the same with the arguments
+         * listed in the documentation of the WavefrontImplementation() constructor, plus:
+         * - {@code -threshold <integer with the cost in cells from which a pair is aligned by all the threads>} (optional, tuned
+         * automatically for every batch of pairs by default, see WavefrontImplementation#tune_threshold())<br>
+         * - {@code -no-pin} (optional, the workers are not pinned to processors)<br>
+         * Any extra (and possibly invalid) arguments are ignored without throwing any exception.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing, or the number of threads,
+         * the tile size or the threshold is not positive.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         * @throws std::system_error Thrown if the threads cannot be created.
+         */
+        ThreadPoolImplementation(int argc, char* argv[]);
+
+        /**
+         * Stops the threads and destroys an instance of the current class by calling the ~WavefrontImplementation() destructor
+         * of the parent class.
+         */
+        virtual ~ThreadPoolImplementation();
+
+        /**
+         * Executes the <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * in a parallel way (multiple threads). The expensive pairs are aligned first, each of them by all the threads,
+         * and then the rest of the pairs are aligned in parallel, each of them by a single thread.
+         */
+        void alignPairs(void) final;
+
+        /**
+         * Prints some statistics into console about the execution details of the algorithm.
+         */
+        void printStatistics(void) final;
+
+    private:
+        /**
+         * The state of a thread, which is used only by that thread while the pairs are aligned.
+         * @author Georgios Apostolakis
+         */
+        struct alignas(64) ThreadState {
+            /** The scoring matrix of the pairs that the thread aligns alone, which is reused for all of them. */
+            ScoringMatrix matrix;
+
+            /** The cells with the maximum value of the tiles of the thread, in a wavefront. */
+            OptimumTracker tracker;
+
+            /** The cells with the maximum value of the current pair in row-major order, for its tracebacks. */
+            vector<Position> max_pos;
+
+            /** The cells with value greater than zero, found by the thread in a wavefront. */
+            long long int tileCells;
+
+            /** The number of cells with value greater than zero (for the statistics). */
+            long long int cells;
+
+            /** The number of traceback steps (for the statistics). */
+            long long int steps;
+
+            /** The allocations of the {@link #matrix} that have been added to the statistics. */
+            long long int allocations;
+
+            /** The time of computing the cells of the pairs that the thread aligned alone (for the statistics). */
+            long double fillTime;
+
+            /** The time of the tracebacks of the pairs that the thread aligned alone (for the statistics). */
+            long double tracebackTime;
+        };
+
+        /** The cost (in cells) from which a pair is aligned by all the threads, as given by the user (0 if it is tuned automatically). */
+        long long int threshold;
+
+        /** The threshold that was used for the last batch of pairs (for the statistics). */
+        long long int usedThreshold;
+
+        /** The workers, i.e. all the threads except for the one that calls #alignPairs(). */
+        ThreadPool* pool;
+
+        /** The state of every thread, in the order of ThreadPool#index() (an array, since the matrices cannot be copied). */
+        unique_ptr<ThreadState[]> states;
+
+        /** The number of pairs that were aligned by all the threads (for the statistics). */
+        long long int wavefrontPairs;
+
+        /** The number of pairs that were aligned by a single thread (for the statistics). */
+        atomic<long long int> singlePairs;
+
+        /** The time that was spent on the pairs aligned by all the threads (for the statistics). */
+        long double wavefrontTime;
+
+        /** The time that was spent on the pairs aligned by single threads (for the statistics). */
+        long double singleTime;
+
+        /**
+         * Fills the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with all the threads (for the {@link Pair} of sequences provided as argument). Every tile of the matrix is a task
+         * of the {@link #pool}, which is submitted when the tiles it depends on are computed. It must be called by the thread
+         * that calls #alignPairs().
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param index The index of the pair in the input file, with which the tiles are recorded in the trace.
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm. Every cell will contain an integer value.
+         * @param max_pos_vec A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_wavefront(const Pair& sequences, size_t index, ScoringMatrix& scoring_matrix, vector<Position>& max_pos_vec) final;
+
+        /**
+         * Aligns a pair with the calling thread only (a task of the {@link #pool}).
+         * @param i The index of the pair in the {@link #data}.
+         */
+        void align_pair(size_t i);
+};
\ No newline at end of file
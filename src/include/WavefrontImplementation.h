@@ -0,0 +1,116 @@
+/**
+ * @file WavefrontImplementation.h
+ */
+#pragma once
+
+#include "Framework.h"
+#include "OptimumTracker.h"
+
+using namespace std;
+
+/**
+ * This abstract class extends the {@link Framework} class with the parts that are shared by the versions of the
+ * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a> which split
+ * the scoring matrix into square tiles and compute them as a wavefront with multiple threads (the fine-grained, the
+ * hybrid and the thread pool versions). It parses their common arguments, fills the tiles of a matrix and traces
+ * back its alignments, while every descendant class decides how the tiles and the pairs are distributed to the threads.
+ * @author Georgios Apostolakis
+ */
+class WavefrontImplementation : public Framework {
+    public:
+        /**
+         * Calls the Framework() constructor of the parent class and also determines the number of threads that will be used.
+         * If no arguments are provided by the user it asks for them through console questions.
+         * The valid arguments are the same with the arguments listed in the documentation of the Framework() constructor, plus:
+         * - {@code -threads <integer with the threads for parallelization>}<br>
+         * - {@code -tile <integer with the size of the tiles>} (optional, {@link #DEFAULT_TILE} by default)<br>
+         * Any extra (and possibly invalid) arguments are ignored without throwing any exception.
+         * @param argc An integer with the size of the {@code argv} argument.
+         * @param argv An array with the arguments provided by the user.
+         * @throws std::ios_base::failure Thrown if the input or output file cannot be opened.
+         * @throws std::invalid_argument Thrown if some arguments from the listed above are missing, or the number of threads
+         * or the tile size is not positive.
+         * @throws std::runtime_error Thrown if the contents of the input file are invalid.
+         */
+        WavefrontImplementation(int argc, char* argv[]);
+
+        /**
+         * Destroys an instance of the current class by calling the ~Framework() destructor
+         * of the parent class.
+         */
+        virtual ~WavefrontImplementation();
+
+    protected:
+        /** The size (in rows and columns) of the tiles when the size is not provided by the user. */
+        static const unsigned int DEFAULT_TILE = 256;
+
+        /** The maximum number of threads to use for parallelization **/
+        unsigned int threads;
+
+        /** The size (in rows and columns) of the tiles of the scoring matrix. */
+        unsigned int tile;
+
+        /**
+         * Provides a threshold for the pairs of the current batch, from which a pair is aligned by all the threads. A pair is
+         * aligned by all the threads if it costs more than the fair share of a thread (the total cost divided by the number of
+         * threads), since no assignment of whole pairs to the threads could balance it, and if its matrix has at least as many
+         * tiles per row and per column as the threads, so that there are enough tiles to keep all the threads busy.
+         * @return A long long integer with the threshold in cells.
+         */
+        long long int tune_threshold(void);
+
+        /**
+         * Fills the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with all the threads (for the {@link Pair} of sequences provided as argument). By default the tiles of every anti-diagonal
+         * of the matrix are computed by different OpenMP threads, so it must be called outside of a parallel region.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param index The index of the pair in the input file, with which the tiles are recorded in the trace.
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm. Every cell will contain an integer value.
+         * @param max_pos_vec A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        virtual long long int fill_wavefront(const Pair& sequences, size_t index, ScoringMatrix& scoring_matrix, vector<Position>& max_pos_vec);
+
+        /**
+         * Fills the scoring matrix of the
+         * <a href="https://en.wikipedia.org/wiki/Smith%E2%80%93Waterman_algorithm">Smith-Waterman algorithm</a>
+         * with the calling thread only (for the {@link Pair} of sequences provided as argument).
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix A {@link ScoringMatrix} object, whose cells will be filled according to the process
+         * defined by the algorithm. Every cell will contain an integer value.
+         * @param max_pos_vec A vector whose entries are of type {@link Position} and hold the coordinates of the cells with maximum value.
+         * @return A long long integer with the number of cells whose entries are greater than zero.
+         */
+        long long int fill_sequential(const Pair& sequences, ScoringMatrix& scoring_matrix, vector<Position>& max_pos_vec);
+
+        /**
+         * Fills a tile of the scoring matrix sequentially. The row above the tile and the column before it must have been computed.
+         * @param sequences A {@link Pair} object with the sequences that will be aligned.
+         * @param scoring_matrix The {@link ScoringMatrix} object which is filled.
+         * @param row0 The top row of the tile.
+         * @param col0 The left column of the tile.
+         * @param row1 The bottom row of the tile.
+         * @param col1 The right column of the tile.
+         * @param tracker The {@link OptimumTracker} with the cells of maximum value found so far by the current thread (it is updated).
+         * @param cells The number of cells with value greater than zero found so far by the current thread (it is updated).
+         */
+        void fill_tile(const Pair& sequences, ScoringMatrix& scoring_matrix, size_t row0, size_t col0, size_t row1, size_t col1,
+                       OptimumTracker& tracker, long long int& cells);
+
+        /**
+         * Sets the first row and the first column of a scoring matrix to zero, before its tiles are filled.
+         * @param scoring_matrix The {@link ScoringMatrix} object which is filled.
+         */
+        void clear_borders(ScoringMatrix& scoring_matrix);
+
+        /**
+         * Traces back all the optimal alignments of a pair, whose scoring matrix has been filled.
+         * @param i The index of the pair in the {@link #data}.
+         * @param scoring_matrix The filled {@link ScoringMatrix} of the pair.
+         * @param max_pos_vec The cells with the maximum value of the matrix.
+         * @return A long long integer with the number of traceback steps that were performed.
+         */
+        long long int trace_pair(size_t i, const ScoringMatrix& scoring_matrix, const vector<Position>& max_pos_vec);
+};
\ No newline at end of file
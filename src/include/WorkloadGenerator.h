@@ -0,0 +1,143 @@
+/**
+ * @file WorkloadGenerator.h
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+#include <random>
+
+using namespace std;
+
+/**
+* The distribution of the lengths of the Q sequences of a synthetic workload.
+* @author Georgios Apostolakis
+*/
+enum LengthDistribution {
+    /** Every sequence has the same length. */
+    FIXED_LENGTH,
+
+    /** The lengths are uniformly distributed between a minimum and a maximum. */
+    UNIFORM_LENGTH,
+
+    /** The logarithms of the lengths are normally distributed (a few sequences are much longer than the rest). */
+    LOG_NORMAL_LENGTH
+};
+
+/**
+* The settings of a synthetic workload.
+* @author Georgios Apostolakis
+*/
+struct WorkloadSettings {
+    /** The number of pairs of sequences. */
+    size_t pairs;
+
+    /** The distribution of the lengths of the Q sequences. */
+    LengthDistribution distribution;
+
+    /**
+     * The first parameter of the {@link #distribution}: the length of the {@link FIXED_LENGTH} distribution, the minimum length
+     * of the {@link UNIFORM_LENGTH} distribution, or the median length of the {@link LOG_NORMAL_LENGTH} distribution.
+     */
+    double lengthA;
+
+    /**
+     * The second parameter of the {@link #distribution}: the maximum length of the {@link UNIFORM_LENGTH} distribution, or the
+     * standard deviation of the logarithm of the length for the {@link LOG_NORMAL_LENGTH} distribution (ignored by the
+     * {@link FIXED_LENGTH} distribution).
+     */
+    double lengthB;
+
+    /** The symbols of the sequences. */
+    string alphabet;
+
+    /**
+     * The probability that a symbol of a Q sequence is mutated in its D sequence (half of the mutations are substitutions,
+     * a quarter insertions and a quarter deletions). With 0 the D sequence is a copy of the Q sequence.
+     */
+    double mutationRate;
+
+    /**
+     * The probability that a pair is a copy of an earlier pair of the workload (such pairs are found in the cache). The copied pair
+     * is one of the last {@link WorkloadGenerator#DUPLICATE_WINDOW} distinct pairs, so the memory of the generator stays bounded.
+     */
+    double duplicateRatio;
+
+    /** The seed of the random generator (the same settings always produce the same workload). */
+    uint64_t seed;
+};
+
+/**
+ * Generates synthetic pairs of sequences in the format of the input files (see the Framework() constructor),
+ * so that the versions of the algorithm can be studied with loads of any size and shape.
+ * The random numbers are produced without the distributions of the standard library, whose output is implementation-specific,
+ * so a seed produces the same workload with every compiler.
+ * @author Georgios Apostolakis
+ */
+class WorkloadGenerator {
+    public:
+        /**
+         * Constructs a new instance of this class.
+         * @param settings The {@link WorkloadSettings} of the workload.
+         * @throws std::invalid_argument Thrown if the settings are invalid (e.g. an empty alphabet or a rate outside [0, 1]).
+         */
+        WorkloadGenerator(const WorkloadSettings& settings);
+
+        /**
+         * Writes the workload into a stream.
+         * @param output The stream.
+         */
+        void write(ostream& output);
+
+        /**
+         * Writes the workload into a file.
+         * @param path The path of the file.
+         * @throws std::ios_base::failure Thrown if the file cannot be written.
+         */
+        void write(const string& path);
+
+        /** The number of the most recent distinct pairs that may be copied by the duplicate pairs. */
+        static const size_t DUPLICATE_WINDOW = 1024;
+
+    private:
+        /** The settings of the workload. */
+        WorkloadSettings settings;
+
+        /** The random generator. */
+        mt19937_64 random;
+
+        /**
+         * Provides a random number which is uniformly distributed in [0, 1).
+         * @return A double with the random number.
+         */
+        double uniform(void);
+
+        /**
+         * Provides a random integer which is uniformly distributed in [0, n).
+         * @param n The number of possible values.
+         * @return The random integer.
+         */
+        size_t below(size_t n);
+
+        /**
+         * Provides the length of the next Q sequence, according to the distribution of the {@link #settings}.
+         * @return The length (at least 1).
+         */
+        size_t next_length(void);
+
+        /**
+         * Generates a random sequence.
+         * @param length The length of the sequence.
+         * @return A string with the symbols of the sequence.
+         */
+        string random_sequence(size_t length);
+
+        /**
+         * Generates the D sequence of a pair, by mutating the Q sequence.
+         * @param q The Q sequence.
+         * @return A string with the symbols of the D sequence.
+         */
+        string mutate(const string& q);
+};